@@ -0,0 +1,120 @@
+/**
+ * @file Benchmark_Arduino.ino
+ * @author Piotr Zapart
+ * @brief CPU load benchmark for the basic components and the phaser
+ * 			int16_t standard Teensy Audio library compatible
+ * 		required libraries:
+ * 			HexeFX_audiolib_I16 https://github.com/hexeguitar/hexefx_audiolib_I16
+ *
+ * 	MCU: Teensy4.0/4.1
+ *  USB: SERIAL
+ * 	Results are printed as CPU cycles per sample and CPU load per instance
+ *
+ * @version 0.1
+ * @date 2024-12-10
+ *
+ * @copyright Copyright www.hexefx.com (c) 2024
+ *
+ */
+#include <Audio.h>
+#include <hexefx_audiolib_i16.h>
+
+#ifndef DBG_SERIAL
+	#define DBG_SERIAL Serial
+#endif
+
+#define BENCH_BLOCKS	(1000)
+
+AudioBasicPitch		pitch;
+AudioEffectPhaserStereo_i16	phaser;
+
+float32_t bufIn[AUDIO_BLOCK_SAMPLES];
+float32_t bufOut[AUDIO_BLOCK_SAMPLES];
+
+const char *interpNames[] = {"drop sample", "linear", "hermite"};
+
+void printResult(const char *name, uint32_t cycles)
+{
+	float32_t cps = (float32_t)cycles / (float32_t)(BENCH_BLOCKS * AUDIO_BLOCK_SAMPLES);
+	float32_t load = cps * AUDIO_SAMPLE_RATE_EXACT / (float32_t)F_CPU_ACTUAL * 100.0f;
+	DBG_SERIAL.printf("%-32s %6.1f cycles/sample  %5.2f%% CPU\r\n", name, cps, load);
+}
+
+void benchPitch()
+{
+	uint32_t t0, i, j;
+	char name[48];
+
+	pitch.setPitch(2.0f);
+	pitch.setMix(1.0f);
+	for (i = PITCH_INTERP_DROP; i <= PITCH_INTERP_HERMITE; i++)
+	{
+		pitch.setInterpolation((pitch_interp_t)i);
+		// per sample processing
+		t0 = ARM_DWT_CYCCNT;
+		for (j = 0; j < BENCH_BLOCKS; j++)
+		{
+			for (uint32_t k = 0; k < AUDIO_BLOCK_SAMPLES; k++)	bufOut[k] = pitch.process(bufIn[k]);
+		}
+		snprintf(name, sizeof(name), "pitch process() %s", interpNames[i]);
+		printResult(name, ARM_DWT_CYCCNT - t0);
+		// block processing
+		t0 = ARM_DWT_CYCCNT;
+		for (j = 0; j < BENCH_BLOCKS; j++)
+		{
+			pitch.processBlock(bufIn, bufOut, AUDIO_BLOCK_SAMPLES);
+		}
+		snprintf(name, sizeof(name), "pitch processBlock() %s", interpNames[i]);
+		printResult(name, ARM_DWT_CYCCNT - t0);
+	}
+	// disabled
+	pitch.setMix(0.0f);
+	t0 = ARM_DWT_CYCCNT;
+	for (j = 0; j < BENCH_BLOCKS; j++)
+	{
+		pitch.processBlock(bufIn, bufOut, AUDIO_BLOCK_SAMPLES);
+	}
+	printResult("pitch processBlock() disabled", ARM_DWT_CYCCNT - t0);
+}
+
+void benchPhaser()
+{
+	uint32_t t0, i, j;
+	char name[48];
+
+	// not connected, each update() allocates and processes silent input blocks
+	phaser.lfo(0.5f, 0.3f, 0.9f, 0.1f);
+	phaser.feedback(0.5f);
+	for (i = 2; i <= PHASER_STEREO_STAGES; i += 2)
+	{
+		phaser.stages(i);
+		t0 = ARM_DWT_CYCCNT;
+		for (j = 0; j < BENCH_BLOCKS; j++)
+		{
+			phaser.update();
+		}
+		snprintf(name, sizeof(name), "phaser update() %lu stages", i);
+		printResult(name, ARM_DWT_CYCCNT - t0);
+	}
+}
+
+void setup()
+{
+	DBG_SERIAL.begin(115200);
+	while (!DBG_SERIAL && millis() < 3000);
+	DBG_SERIAL.println("hexefx_audiolib_i16 - CPU benchmark");
+	AudioMemory(4);
+
+	for (uint32_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+	{
+		bufIn[i] = 0.5f * sinf(2.0f * PI * (float32_t)i / (float32_t)AUDIO_BLOCK_SAMPLES);
+	}
+	if (!pitch.init()) DBG_SERIAL.println("Pitch shifter memory allocation failed!");
+
+	benchPitch();
+	benchPhaser();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,121 @@
+/**
+ * @file DelayStereoMulti_Arduino.ino
+ * @author Piotr Zapart
+ * @brief Multi instance stress test for the Stereo Ping-Pong Modulated Delay component
+ * 			int16_t standard Teensy Audio library compatible
+ * 		Two independent delays (short slapback and a long ping-pong) run in series.
+ * 		The slapback is bypassed/enabled and retimed periodically, the ping-pong
+ * 		has to keep running undisturbed: smooth delay time, no dropouts or glitches
+ * 		while the other instance clears its buffers.
+ * 		required libraries:
+ * 			HexeFX_audiolib_I16 https://github.com/hexeguitar/hexefx_audiolib_I16
+ *
+ * 	MCU: Teensy4.0/4.1
+ *  USB: SERIAL
+ *
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright www.hexefx.com (c) 2024
+ *
+ */
+#include <Audio.h>
+#include <hexefx_audiolib_i16.h>
+
+#ifndef DBG_SERIAL
+	#define DBG_SERIAL Serial
+#endif
+
+AudioControlSGTL5000			codec;
+AudioInputI2S					i2s_in;
+AudioEffectDelayStereo_i16		slapback(150);
+AudioEffectDelayStereo_i16		pingpong(400);		// both buffers have to fit into RAM2
+AudioOutputI2S	     			i2s_out;
+
+AudioConnection     cable1(i2s_in, 0, slapback, 0);
+AudioConnection     cable2(i2s_in, 1, slapback, 1);
+AudioConnection     cable3(slapback, 0, pingpong, 0);
+AudioConnection     cable4(slapback, 1, pingpong, 1);
+AudioConnection     cable5(pingpong, 0, i2s_out, 0);
+AudioConnection     cable6(pingpong, 1, i2s_out, 1);
+
+#define SLAP_TOGGLE_MS	(1500)	// slapback bypass toggle period
+#define PRINT_MS		(500)
+
+uint32_t timeNow, timePrint, timeToggle;
+uint32_t toggleCnt = 0;
+const char PROGMEM *termPosHome = "\x1b[;H";
+
+void printInfo(void);
+
+void setup()
+{
+	DBG_SERIAL.begin(115200);
+
+	AudioMemory(20);
+
+	if (!codec.enable()) DBG_SERIAL.println("Codec init error!");
+	codec.inputSelect(AUDIO_INPUT_LINEIN);
+	codec.volume(0.8f);
+	codec.lineInLevel(10, 10);
+	codec.adcHighPassFilterDisable();
+
+	DBG_SERIAL.println("Codec initialized.");
+	if (!slapback.is_initialized()) DBG_SERIAL.println("Slapback memory allocation failed!");
+	if (!pingpong.is_initialized()) DBG_SERIAL.println("Pingpong memory allocation failed!");
+
+	slapback.time(0.3f, true);
+	slapback.feedback(0.1f);
+	slapback.mix(0.4f);
+	slapback.bypass_set(false);
+
+	pingpong.time(0.8f, true);
+	pingpong.feedback(0.6f);
+	pingpong.mod_rate(0.3f);
+	pingpong.mod_depth(0.3f);
+	pingpong.mix(0.5f);
+	pingpong.bypass_set(false);
+}
+
+void loop()
+{
+	timeNow = millis();
+	if (timeNow - timeToggle > SLAP_TOGGLE_MS)
+	{
+		// bypass starts the slapback buffer cleanup, the ping-pong has to stay unaffected
+		slapback.bypass_tgl();
+		// retime the slapback, smoothed delay time changes must not leak into the other instance
+		slapback.time((toggleCnt & 1) ? 0.3f : 0.6f);
+		toggleCnt++;
+		timeToggle = timeNow;
+	}
+	if (timeNow - timePrint > PRINT_MS)
+	{
+		printInfo();
+		timePrint = timeNow;
+	}
+}
+
+void printInfo(void)
+{
+	static const char *on = "\x1b[32mon \x1b[0m";
+	static const char *off = "\x1b[31moff\x1b[0m";
+	float load_slap = slapback.processorUsageMax();
+	float load_pp = pingpong.processorUsageMax();
+	slapback.processorUsageMaxReset();
+	pingpong.processorUsageMaxReset();
+
+	float load = AudioProcessorUsageMax();
+	AudioProcessorUsageMaxReset();
+
+	DBG_SERIAL.printf("%sCPU usage: slapback = %2.2f%% pingpong = %2.2f%% max = %2.2f%%   \r\n",
+						termPosHome, load_slap, load_pp, load);
+	DBG_SERIAL.printf("Slapback %s \tPingpong %s \ttoggles: %lu   \r\n",
+						slapback.bypass_get() ? off : on,
+						pingpong.bypass_get() ? off : on,
+						toggleCnt);
+	DBG_SERIAL.printf("Initialized: slapback %s \tpingpong %s   \r\n",
+						slapback.is_initialized() ? on : off,
+						pingpong.is_initialized() ? on : off);
+	DBG_SERIAL.printf("Audio blocks used: %d max: %d   \r\n", AudioMemoryUsage(), AudioMemoryUsageMax());
+}
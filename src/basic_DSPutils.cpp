@@ -40,3 +40,23 @@ void scale_float_to_int32range(const float32_t *pSrc, float32_t *pDst, uint32_t
 	}
 }
 
+/**
+ * @brief linear crossfade between two vectors over the whole block,
+ * 	used to switch between two signal paths without clicks
+ * 
+ * @param pDst 	pointer to the destination vector, also the 1st input
+ * @param pSrc 	pointer to the 2nd input vector
+ * @param blockSize 
+ * @param toSrc true = fade from pDst to pSrc, false = fade from pSrc to pDst
+ */
+void xfade_f32(float32_t *pDst, const float32_t *pSrc, uint32_t blockSize, bool toSrc)
+{
+	float32_t xf;
+	const float32_t step = 1.0f / (float32_t)blockSize;
+	for (uint32_t i = 0; i < blockSize; i++)
+	{
+		xf = (float32_t)i * step;
+		if (!toSrc) xf = 1.0f - xf;
+		pDst[i] += (pSrc[i] - pDst[i]) * xf;
+	}
+}
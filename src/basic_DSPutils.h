@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <arm_math.h>
+#include "AudioStream.h"
 #include "utility/dspinst.h"
 
 #define F32_TO_I32_NORM_FACTOR 	(2147483647) // which is 2^31-1
@@ -10,6 +11,20 @@
 #define I24_TO_F32_NORM_FACTOR	(1.1920930376163766e-07)	// 1/(2^23 - 1)
 #define I16_TO_F32_NORM_FACTOR	(3.051850947599719e-05)
 
+#define BASIC_SR_REF			(44117.64706f)	// sample rate the delay lengths in the effects are tuned for
+
+/**
+ * @brief Scales a delay length tuned for BASIC_SR_REF to the current sample rate,
+ * 		can be used in the compile time constants and template parameters
+ * 
+ * @param len delay length in samples at BASIC_SR_REF
+ * @return constexpr uint32_t delay length at AUDIO_SAMPLE_RATE_EXACT
+ */
+constexpr uint32_t sr_scale_len(uint32_t len)
+{
+	return (uint32_t)((float)len * (AUDIO_SAMPLE_RATE_EXACT / BASIC_SR_REF) + 0.5f);
+}
+
 
 static inline void mix_pwr(float32_t mix, float32_t *wetMix, float32_t *dryMix);
 static inline void mix_pwr(float32_t mix, float32_t *wetMix, float32_t *dryMix)
@@ -47,6 +62,7 @@ static inline void mix_const_ampl_i16(int16_t mix, int16_t *wetMix, int16_t *dry
 }
 
 void scale_float_to_int32range(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void xfade_f32(float32_t *pDst, const float32_t *pSrc, uint32_t blockSize, bool toSrc);
 
 /**
   * @brief  combine two separate buffers into interleaved one
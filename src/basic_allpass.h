@@ -55,6 +55,25 @@ public:
 		if (++idx >= N) idx = 0;
 		return out;
 	}
+	/**
+	 * @brief process a block of samples
+	 * 
+	 * @param src input buffer
+	 * @param dst output buffer, can be the same as src
+	 * @param len number of samples
+	 */
+	void processBlock(const float *src, float *dst, uint32_t len)
+	{
+		float in, out, k = *kPtr;
+		while (len--)
+		{
+			in = *src++;
+			out = bf[idx] + k * in;
+			bf[idx] = in - k * out;
+			if (++idx >= N) idx = 0;
+			*dst++ = out;
+		}
+	}
 	/**
 	 * @brief Set new coeff pointer
 	 * 
@@ -94,4 +113,237 @@ private:
 };
 
 
+/**
+ * @brief Allpass filter with the buffer allocated at runtime in RAM or PSRAM.
+ * 		The delay length can be set per sample up to the buffer size, length changes 
+ * 		are done by crossfading the old and new read positions.
+ */
+class AudioFilterAllpassVar
+{
+public:
+	AudioFilterAllpassVar() { bf = NULL; }
+	~AudioFilterAllpassVar() { extmem_free(bf); }
+	/**
+	 * @brief Allocate the filter buffer 
+	 * 
+	 * @param size_samples 	buffer size = max delay length
+	 * @param coeffPtr 		pointer to the allpas coeff variable
+	 * @param psram 		true to place the buffer in PSRAM
+	 */
+	bool init(uint32_t size_samples, float* coeffPtr, bool psram=false)
+	{
+		extmem_free(bf);
+		use_psram = psram;
+		size = size_samples;
+		if (use_psram) 	bf = (float *)extmem_malloc(size * sizeof(float));
+		else 			bf = (float *)malloc(size * sizeof(float));
+		if (!bf) return false;
+		kPtr = coeffPtr;
+		idx = 0;
+		reset();
+		return true;
+	}
+	void reset()
+	{
+		memset(bf, 0, size * sizeof(float));
+		if (use_psram) arm_dcache_flush_delete(&bf[0], size * sizeof(float));
+	}
+	void reset(uint32_t startAddr, uint32_t endAddr)
+	{
+		if (startAddr > endAddr) return;
+		if (endAddr > (uint32_t)size) endAddr = size;
+		float* memPtr = &bf[0]+startAddr;
+		uint32_t l = (endAddr - startAddr) * sizeof(float);
+		memset(memPtr, 0, l);
+		if (use_psram) arm_dcache_flush_delete(memPtr, l);
+	}
+	uint32_t size_get() {return size;}
+	/**
+	 * @brief process new sample
+	 * 
+	 * @param in input sample
+	 * @param len delay length, 1 to buffer size
+	 * @return float output sample
+	 */
+	inline float process(float in, uint32_t len)
+	{
+		float out = tap(len) + (*kPtr) * in;
+		bf[idx] = in - (*kPtr) * out;
+		if (++idx >= size) idx = 0;
+		return out;
+	}
+	/**
+	 * @brief process new sample while changing the delay length
+	 * 
+	 * @param in input sample
+	 * @param lenA old delay length
+	 * @param lenB new delay length
+	 * @param xf crossfade position, 0.0f = lenA, 1.0f = lenB
+	 * @return float output sample
+	 */
+	inline float process(float in, uint32_t lenA, uint32_t lenB, float xf)
+	{
+		float out = tap(lenA)*(1.0f-xf) + tap(lenB)*xf + (*kPtr) * in;
+		bf[idx] = in - (*kPtr) * out;
+		if (++idx >= size) idx = 0;
+		return out;
+	}
+private:
+	float *kPtr;
+	float *bf;
+	int32_t size;
+	int32_t idx;
+	bool use_psram = false;
+
+	inline float tap(uint32_t offset)
+	{
+		int32_t read_idx = idx - offset;
+		if (read_idx < 0) read_idx += size;
+		return bf[read_idx];
+	}
+};
+
+/**
+ * @brief Bank of short stereo allpass filters with the same delay length, connected in series.
+ * 		All filters advance in lockstep and share a single buffer index. The buffer is organized
+ * 		as structure of arrays, the states of all stages for one index are placed next
+ * 		to each other, L and R interleaved. This way the whole chain is processed in a simple
+ * 		loop with sequential memory access.
+ */
+class AudioFilterAllpassBank
+{
+public:
+	AudioFilterAllpassBank() { bf = NULL; kL = NULL; kR = NULL; }
+	~AudioFilterAllpassBank() { free(bf); free(kL); free(kR); }
+	/**
+	 * @brief Allocate the filter buffer and the coefficients
+	 * 
+	 * @param length 	delay length of every allpass in the bank
+	 * @param numStages number of allpass stages per channel
+	 */
+	bool init(uint32_t length, uint32_t numStages)
+	{
+		free(bf); free(kL); free(kR);
+		len = length;
+		stagesMax = numStages;
+		stages = stagesNext = numStages;
+		bf = (float *)malloc(len * stagesMax * 2 * sizeof(float));
+		kL = (float *)malloc(stagesMax * sizeof(float));
+		kR = (float *)malloc(stagesMax * sizeof(float));
+		if (!bf || !kL || !kR) return false;
+		memset(kL, 0, stagesMax * sizeof(float));
+		memset(kR, 0, stagesMax * sizeof(float));
+		reset();
+		return true;
+	}
+	void reset()
+	{
+		memset(bf, 0, len * stagesMax * 2 * sizeof(float));
+		idx = 0;
+	}
+	/**
+	 * @brief set the coefficients for one stage
+	 * 
+	 * @param stage stage number, 0 = first in the chain
+	 * @param coeffL allpass coeff, channel L
+	 * @param coeffR allpass coeff, channel R
+	 */
+	void coeff(uint32_t stage, float coeffL, float coeffR)
+	{
+		if (stage >= stagesMax) return;
+		kL[stage] = coeffL;
+		kR[stage] = coeffR;
+	}
+	/**
+	 * @brief set the number of active stages, the buffers stay allocated for the max number
+	 * 		set in init(). States of the newly enabled stages are cleared.
+	 * 		The change is pending until the stages_update() call, process() with the crossfade
+	 * 		parameter can be used to morph between the old and the new number of stages.
+	 * 
+	 * @param numStages active stages per channel, 1 to max
+	 */
+	void stages_set(uint32_t numStages)
+	{
+		numStages = constrain(numStages, 1u, stagesMax);
+		if (numStages > stages)
+		{
+			for (uint32_t i = 0; i < len; i++)
+			{
+				memset(&bf[(i * stagesMax + stages) * 2], 0, (numStages - stages) * 2 * sizeof(float));
+			}
+		}
+		stagesNext = numStages;
+	}
+	uint32_t stages_get() {return stagesNext;}
+	bool stages_pending() {return stagesNext != stages;}
+	/**
+	 * @brief apply the pending number of stages
+	 */
+	void stages_update() {stages = stagesNext;}
+	/**
+	 * @brief process a new stereo sample through all stages
+	 * 
+	 * @param inL input/output sample L
+	 * @param inR input/output sample R
+	 */
+	inline void process(float &inL, float &inR)
+	{
+		float *p = &bf[idx * stagesMax * 2];
+		float l = inL, r = inR, accL, accR;
+		for (uint32_t i = 0; i < stages; i++)
+		{
+			accL = p[0] + l * kL[i];
+			accR = p[1] + r * kR[i];
+			p[0] = l - kL[i] * accL;
+			p[1] = r - kR[i] * accR;
+			l = accL;
+			r = accR;
+			p += 2;
+		}
+		if (++idx >= len) idx = 0;
+		inL = l;
+		inR = r;
+	}
+	/**
+	 * @brief process a new stereo sample while the number of stages is changing.
+	 * 		All stages used by the old or the new setting are processed, the output 
+	 * 		is crossfaded from the old to the new number of stages.
+	 * 
+	 * @param inL input/output sample L
+	 * @param inR input/output sample R
+	 * @param xf crossfade position, 0.0f = old number of stages, 1.0f = new
+	 */
+	inline void process(float &inL, float &inR, float xf)
+	{
+		float *p = &bf[idx * stagesMax * 2];
+		float l = inL, r = inR, accL, accR;
+		float oldL = 0.0f, oldR = 0.0f, newL = 0.0f, newR = 0.0f;
+		uint32_t n = max(stages, stagesNext);
+		for (uint32_t i = 0; i < n; i++)
+		{
+			accL = p[0] + l * kL[i];
+			accR = p[1] + r * kR[i];
+			p[0] = l - kL[i] * accL;
+			p[1] = r - kR[i] * accR;
+			l = accL;
+			r = accR;
+			p += 2;
+			if (i + 1 == stages)		{ oldL = l; oldR = r; }
+			if (i + 1 == stagesNext)	{ newL = l; newR = r; }
+		}
+		if (++idx >= len) idx = 0;
+		inL = oldL + (newL - oldL) * xf;
+		inR = oldR + (newR - oldR) * xf;
+	}
+private:
+	float *bf;
+	float *kL;
+	float *kR;
+	uint32_t len;
+	uint32_t stagesMax;
+	uint32_t stages;
+	uint32_t stagesNext;
+	uint32_t idx;
+};
+
 #endif // _FILTER_ALLPASS_H_
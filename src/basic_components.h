@@ -6,6 +6,7 @@
 #include "basic_lfo.h"
 #include "basic_shelvFilter.h"
 #include "basic_pitch.h"
+#include "basic_idle.h"
 #include "basic_DSPutils.h"
 
 // bypass modes used in various components
@@ -12,6 +12,7 @@
 #define _BASIC_DELAY_H_
 
 #include "Arduino.h"
+#include "utility/dspinst.h"
 
 
 /**
@@ -51,6 +52,7 @@ public:
 		memset(memPtr, 0, l);
 		if (use_psram) arm_dcache_flush_delete(memPtr, l);
 	}
+	uint32_t size_get() {return size;}
 	/**
 	 * @brief get the tap from the delay buffer
 	 * 
@@ -68,24 +70,71 @@ public:
 		return (bf[read_idx]*(1.0f-frac) + bf[read_idx_next]*frac);
 	}
 
+	/**
+	 * @brief get the crossfaded value of two taps, used to change the delay length
+	 * 
+	 * @param offsetA 	old delay time 
+	 * @param offsetB 	new delay time
+	 * @param xf 		crossfade position, 0.0f = offsetA, 1.0f = offsetB
+	 * @return float 
+	 */
+	inline float getTapXf(uint32_t offsetA, uint32_t offsetB, float xf)
+	{
+		return (getTap(offsetA)*(1.0f-xf) + getTap(offsetB)*xf);
+	}
+
+	/**
+	 * @brief get the tap from the delay buffer, 4 point hermite interpolation
+	 * 
+	 * @param offset 	delay time
+	 * @param frac 		fractional part of the delay time
+	 * @return float 
+	 */
+	inline float getTapHermite(uint32_t offset, float frac)
+	{
+		int32_t read_idx, i; 
+		read_idx = idx - offset;
+		if (read_idx < 0) read_idx += size;
+		const float x0 = bf[read_idx];
+		i = read_idx + 1; 	if (i >= size) i -= size;
+		const float xm1 = offset ? bf[i] : x0;	// offset 0 is the newest sample
+		i = read_idx - 1;	if (i < 0) i += size;
+		const float x1 = bf[i];
+		i = read_idx - 2;	if (i < 0) i += size;
+		const float x2 = bf[i];
+		const float c     = (x1 - xm1) * 0.5f;
+		const float v     = x0 - x1;
+		const float w     = c + v;
+		const float a     = w + v + (x2 - x0) * 0.5f;
+		const float b_neg = w + a;
+		return (((a * frac) - b_neg) * frac + c) * frac + x0;
+	}
+
     inline const float getTapHermite(float delay) const
     {
         int32_t delay_integral   = static_cast<int32_t>(delay);
         float   delay_fractional = delay - static_cast<float>(delay_integral);
 
         int32_t     t     = (idx + delay_integral + size);
-        const float     xm1   = bf[(t - 1) % size];
-        const float     x0    = bf[(t) % size];
-        const float     x1    = bf[(t + 1) % size];
-        const float     x2    = bf[(t + 2) % size];
-        const float c     = (x1 - xm1) * 0.5f;
-        const float v     = x0 - x1;
+        const float     x[4]  = {bf[(t - 1) % size], bf[(t) % size], bf[(t + 1) % size], bf[(t + 2) % size]};
+        return interpHermite(x, delay_fractional);
+    }
+	/**
+	 * @brief 4 point hermite interpolation
+	 * 
+	 * @param x 	4 consecutive samples, interpolated between x[1] and x[2]
+	 * @param f 	fractional position
+	 * @return float 
+	 */
+	static inline float interpHermite(const float *x, float f)
+	{
+        const float c     = (x[2] - x[0]) * 0.5f;
+        const float v     = x[1] - x[2];
         const float w     = c + v;
-        const float a     = w + v + (x2 - x0) * 0.5f;
+        const float a     = w + v + (x[3] - x[1]) * 0.5f;
         const float b_neg = w + a;
-        const float f     = delay_fractional;
-        return (((a * f) - b_neg) * f + c) * f + x0;
-    }
+        return (((a * f) - b_neg) * f + c) * f + x[1];
+	}
 
 	/**
 	 * @brief read last sample and write a new one
@@ -100,6 +149,16 @@ public:
 		
 		return out; 
 	}
+	/**
+	 * @brief write a new sample to the start address, 
+	 * 		used with getTap(len) for delay lengths shorter than the buffer
+	 * 
+	 * @param newSample 
+	 */
+	inline void write(float newSample)
+	{
+		bf[idx] = newSample;
+	}
 	inline void write_toOffset(float newSample, uint32_t offset)
 	{
 		int32_t write_idx;
@@ -111,6 +170,39 @@ public:
 	{
 		if (++idx >= size) idx = 0;
 	}
+	/**
+	 * @brief copy a contiguous part of the buffer in one pass, 
+	 * 		the positions are relative to the write index as in getTapHermite(float)
+	 * 
+	 * @param start 	first sample position, 0 to buffer size - 1
+	 * @param dst 		destination buffer
+	 * @param len 		number of samples
+	 */
+	inline void readBlock(int32_t start, float *dst, uint32_t len)
+	{
+		int32_t i = idx + start;
+		if (i >= size) i -= size;
+		uint32_t l = size - i;
+		if (l > len) l = len;
+		memcpy(dst, &bf[i], l * sizeof(float));
+		if (len > l) memcpy(dst + l, &bf[0], (len - l) * sizeof(float));
+	}
+	/**
+	 * @brief write a block of new samples starting at the write index
+	 * 		and advance the index, same as len times write() + updateIndex()
+	 * 
+	 * @param src 		source buffer
+	 * @param len 		number of samples
+	 */
+	inline void writeBlock(const float *src, uint32_t len)
+	{
+		uint32_t l = size - idx;
+		if (l > len) l = len;
+		memcpy(&bf[idx], src, l * sizeof(float));
+		if (len > l) memcpy(&bf[0], src + l, (len - l) * sizeof(float));
+		idx += len;
+		if (idx >= size) idx -= size;
+	}
 private:
 	int32_t size; 
 	float *bf;
@@ -118,4 +210,111 @@ private:
 	bool use_psram = false;
 };
 
+/**
+ * @brief N delay lines with the same length sharing one buffer and one index. 
+ * 		The samples are interleaved in frames of N, all lines are written with 
+ * 		a single frame access and read from the same memory region.
+ * 
+ * @tparam N number of delay lines
+ * @tparam T sample storage type, float or int16_t (Q15, half the memory)
+ */
+template <int N, typename T = float>
+class AudioBasicDelayMulti
+{
+public:
+	AudioBasicDelayMulti() { bf = NULL; }
+	~AudioBasicDelayMulti() { extmem_free(bf); }
+	/**
+	 * @brief allocate the buffer
+	 * 
+	 * @param size_frames 	delay length in samples (frames)
+	 * @param psram 		true to place the buffer in PSRAM
+	 */
+	bool init(uint32_t size_frames,  bool psram=false)
+	{
+		extmem_free(bf);
+		use_psram = psram;
+		size = size_frames;
+		if (use_psram) 	bf = (T *)extmem_malloc(size * N * sizeof(T));
+		else 			bf = (T *)malloc(size * N * sizeof(T));
+		if (!bf) return false;
+		idx = 0;
+		reset();
+		return true;
+	}
+	void reset()
+	{
+		memset(bf, 0, size * N * sizeof(T));
+		if (use_psram) arm_dcache_flush_delete(&bf[0], size * N * sizeof(T));
+	}
+	/**
+	 * @brief clear a part of the buffer, addresses are in frames
+	 */
+	void reset(uint32_t startAddr, uint32_t endAddr)
+	{
+		if (startAddr > endAddr) return;
+		if (endAddr > (uint32_t)size) endAddr = size;
+		T* memPtr = &bf[startAddr * N];
+		uint32_t l = (endAddr - startAddr) * N * sizeof(T);
+		memset(memPtr, 0, l);
+		if (use_psram) arm_dcache_flush_delete(memPtr, l);
+	}
+	uint32_t size_get() {return size;}
+	/**
+	 * @brief get the tap from one line, 4 point hermite interpolation
+	 * 		the delay is relative to the write index as in AudioBasicDelay::getTapHermite(float)
+	 * 
+	 * @param line 	delay line
+	 * @param delay read position
+	 * @return float 
+	 */
+	inline float getTapHermite(uint32_t line, float delay) const
+	{
+		int32_t delay_integral   = static_cast<int32_t>(delay);
+		float   delay_fractional = delay - static_cast<float>(delay_integral);
+		int32_t t = (idx + delay_integral + size);
+		const float x[4] = {toFloat(bf[((t - 1) % size) * N + line]), toFloat(bf[(t % size) * N + line]), 
+							toFloat(bf[((t + 1) % size) * N + line]), toFloat(bf[((t + 2) % size) * N + line])};
+		return AudioBasicDelay::interpHermite(x, delay_fractional);
+	}
+	/**
+	 * @brief pointer to the frame at the given position relative to the write index
+	 * 
+	 * @param offset 	0 to size-1
+	 * @param len 		number of frames that will be accessed
+	 * @return T* 		NULL if the requested frames wrap around the buffer end
+	 */
+	inline const T* getFrames(uint32_t offset, uint32_t len) const
+	{
+		int32_t i = idx + offset;
+		if (i >= size) i -= size;
+		if (i + len > (uint32_t)size) return NULL;
+		return &bf[i * N];
+	}
+	/**
+	 * @brief write a new frame, one sample per line, to the start address 
+	 */
+	inline void write(const float *frame)
+	{
+		T *p = &bf[idx * N];
+		for (int i = 0; i < N; i++) fromFloat(p[i], frame[i]);
+	}
+	inline void updateIndex()
+	{
+		if (++idx >= size) idx = 0;
+	}
+	/**
+	 * @brief storage format conversion
+	 */
+	static inline float toFloat(float x) { return x; }
+	static inline float toFloat(int16_t x) { return (float)x * (1.0f / 32768.0f); }
+	static inline void fromFloat(float &dst, float x) { dst = x; }
+	static inline void fromFloat(int16_t &dst, float x) { dst = (int16_t)signed_saturate_rshift((int32_t)(x * 32768.0f), 16, 0); }
+private:
+	int32_t size; 
+	T *bf;
+	int32_t idx;
+	bool use_psram = false;
+};
+
 #endif // _BASIC_DELAY_H_
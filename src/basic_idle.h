@@ -0,0 +1,95 @@
+#ifndef _BASIC_IDLE_H_
+#define _BASIC_IDLE_H_
+
+#include <Arduino.h>
+#include "AudioStream.h"
+#include "arm_math.h"
+
+#define BASIC_IDLE_THRESHOLD	(2)		// max abs sample value treated as silence, ~-84dBFS
+
+/**
+ * @brief Tracks the input and the wet signal level once per block.
+ * 		The component goes idle if the input is silent and the wet signal (the reverb
+ * 		tank or delay line outputs, measured before the wet gain) stays below
+ * 		the threshold for the given number of blocks. The hold time has to cover the
+ * 		longest path in the delay network, otherwise the energy still circulating
+ * 		inside could be lost.
+ * 		Processing resumes with the first non silent input block.
+ */
+class AudioBasicIdle
+{
+public:
+	/**
+	 * @brief set the hold time
+	 *
+	 * @param holdBlocks number of silent output blocks required to go idle
+	 */
+	void init(uint32_t holdBlocks)
+	{
+		hold = holdBlocks;
+		reset();
+	}
+	void reset()
+	{
+		cnt = 0;
+		inSilent = false;
+		idle = false;
+	}
+	void threshold(int16_t thr)
+	{
+		thres = thr < 0 ? 0 : thr;
+	}
+	/**
+	 * @brief check the input blocks, call before processing
+	 *
+	 * @param blockL input block L, NULL = silence
+	 * @param blockR input block R, NULL = silence
+	 * @return true if idle and the processing can be skipped
+	 */
+	bool skip(const audio_block_t *blockL, const audio_block_t *blockR)
+	{
+		inSilent = isSilent(blockL) && isSilent(blockR);
+		if (!inSilent)
+		{
+			cnt = 0;
+			idle = false;
+		}
+		return idle;
+	}
+	/**
+	 * @brief check the wet signal level, call after processing
+	 * 
+	 * @param wetPeak peak absolute value of the wet signal in the processed block,
+	 * 			before the wet gain, 1.0f = full scale
+	 */
+	void update(float32_t wetPeak)
+	{
+		if (!inSilent) return;
+		if (wetPeak * 32768.0f <= (float32_t)thres)
+		{
+			if (++cnt >= hold) idle = true;
+		}
+		else cnt = 0;
+	}
+	bool get() { return idle; }
+private:
+	uint32_t hold = 1;
+	uint32_t cnt = 0;
+	int16_t thres = BASIC_IDLE_THRESHOLD;
+	bool inSilent = false;
+	bool idle = false;
+
+	inline bool isSilent(const audio_block_t *block)
+	{
+		if (!block) return true;
+		const int16_t *p = block->data;
+		const int16_t *end = p + AUDIO_BLOCK_SAMPLES;
+		while (p < end)
+		{
+			if (abs(*p++) > thres) return false;
+		}
+		return true;
+	}
+};
+
+#endif // _BASIC_IDLE_H_
@@ -38,6 +38,15 @@ public:
 	{
 		acc += adder; // update the phase acc
 	}
+	/**
+	 * @brief advance the phase by a number of samples at once
+	 * 
+	 * @param samples number of skipped samples
+	 */
+	inline void update(uint32_t samples)
+	{
+		acc += adder * samples;
+	}
 	/**
 	 * @brief LFO output split in two parts
 	 * 
@@ -15,6 +15,17 @@
 #define BASIC_PITCH_XFADE_LEN_HALF	(BASIC_PITCH_XFADE_LEN>>1)
 #define BASIC_PITCH_XFADE_MASK		(BASIC_PITCH_XFADE_LEN-1)
 
+#define BASIC_PITCH_WARMUP_XFADE_LEN	(256)	// wet signal fade in length after re-enabling
+#define BASIC_PITCH_WARMUP_LEN		(BASIC_PITCH_BUF_SIZE + BASIC_PITCH_WARMUP_XFADE_LEN)
+
+// read interpolation, CPU load vs quality
+typedef enum
+{
+	PITCH_INTERP_DROP,			// no interpolation, nearest lower sample
+	PITCH_INTERP_LINEAR,		// 2 point linear interpolation (default)
+	PITCH_INTERP_HERMITE		// 4 point Hermite interpolation
+}pitch_interp_t;
+
 extern "C" {
 extern const float AudioWaveformFader_f32[]; // crossfade waveform
 extern const float music_intevals[];		// semitone intervals -1oct to +2oct
@@ -50,50 +61,137 @@ public:
 
 	inline float process(float newSample)
 	{
-		uint32_t idx1, idx2;
-		uint32_t delta, delta_acc;
-		float k_frac, delta_frac, s_n, s_half, xf0, xf1;
+		uint32_t idx;
+		float k_frac, s_n, s_half, wet;
 
+		// disabled at mix = 0 or if no pitch change, no buffer access at all
+		if (!active_get()) 
+		{
+			warmup = BASIC_PITCH_WARMUP_LEN;	// buffer contents are outdated from now on
+			return newSample;
+		}
 		bf[writeAddr] = newSample;				// write new sample
 		readAddr = readAddr + readAdder;		// update read pointer, readAdder controls the pitch
-		// bypass mode is at mix = 0 or if no pitch change
-		if (mix == 0.0f || readAdder == pitchDelta0) 
+		// warm up after re-enabling: refill the buffer with fresh samples first, output dry signal
+		if (warmup > BASIC_PITCH_WARMUP_XFADE_LEN)
 		{
+			if (warmup == BASIC_PITCH_WARMUP_LEN) outFilter.reset();
+			warmup--;
 			writeAddr = (writeAddr + 1) & BASIC_PITCH_BUF_MASK;
 			return newSample;
 		}
 		// sample end
-		idx1 = (readAddr >> (32-BASIC_PITCH_BUF_BITS)) & BASIC_PITCH_BUF_MASK;						// index of the last sample 
+		idx = (readAddr >> (32-BASIC_PITCH_BUF_BITS)) & BASIC_PITCH_BUF_MASK;						// index of the last sample 
 		k_frac = (float)(readAddr & BASIC_PITCH_BUF_FRAC_MASK) / (float)BASIC_PITCH_BUF_FRAC_MASK;	// fractional part
-	 	s_n = bf[idx1] * (1.0f-k_frac);			
-		s_n += bf[(idx1 + 1) & BASIC_PITCH_BUF_MASK] * k_frac;										// interpolated sample
-		// sample half
-		idx2 = ((readAddr + 0x80000000) >> (32-BASIC_PITCH_BUF_BITS)) & BASIC_PITCH_BUF_MASK;
-		k_frac = (float)((readAddr+0x80000000) & BASIC_PITCH_BUF_FRAC_MASK) / (float)BASIC_PITCH_BUF_FRAC_MASK;
-		s_half = bf[idx2] * (1.0f - k_frac);
-		s_half += bf[(idx2 + 1) & BASIC_PITCH_BUF_MASK] * k_frac;
-
-		delta_acc = readAddr - (writeAddr<<(32-BASIC_PITCH_BUF_BITS));	// distance between the write and read pointer
-		
-		delta = (delta_acc >> (32-9)) & 0x1FF;								// 9 bit value = 2x fade table length (fade in + fade out)
-		delta_frac = (float)(delta_acc & ((1<<23)-1)) / (float)((1<<23)-1);	// fractional part for the xfade curve
-		idx2 = delta&0xFF;
-		xf0 = AudioWaveformFader_f32[idx2];	
-		xf1 = AudioWaveformFader_f32[idx2+1];
-		k_frac = xf0 * (1.0f-delta_frac) + xf1 * delta_frac;	// interpolated smooth crossfade coeff.
+		s_n = read(idx, k_frac);																	// interpolated sample
+		// sample half, half buffer away, the fractional part is the same
+		s_half = read((idx + BASIC_PITCH_BUF_SIZE_HALF) & BASIC_PITCH_BUF_MASK, k_frac);
 
-		if (delta > 0xFF) k_frac = 1.0f-k_frac;					// invert the curve for the fade out part
-		
+		k_frac = xfade_coeff(readAddr - (writeAddr<<(32-BASIC_PITCH_BUF_BITS)));
 		s_n = s_n * k_frac + s_half * (1.0f - k_frac);			// crossfade the last and mid sample
 		
 		writeAddr = (writeAddr + 1) & BASIC_PITCH_BUF_MASK;		// update the write pointer
 		s_n = outFilter.process(s_n);						// apply output lowpass
-		return (s_n * mix + newSample * (1.0f-mix));			// do dry/wet mix
+		wet = mix;
+		if (warmup)												// then fade in the wet signal
+		{
+			wet *= (float)(BASIC_PITCH_WARMUP_XFADE_LEN - warmup) * (1.0f / BASIC_PITCH_WARMUP_XFADE_LEN);
+			warmup--;
+		}
+		return (s_n * wet + newSample * (1.0f-wet));			// do dry/wet mix
+	}
+	/**
+	 * @brief Precompute the read positions and the crossfade envelope for the next block.
+	 * 			Read and write pointers advance at a fixed rate, independent from the signal,
+	 * 			so it can be done once per block, before the samples are available.
+	 * 			Use with processPrepared() inside feedback loops, where the whole block
+	 * 			of input samples is not known in advance. 
+	 * 
+	 * @param len block length, max AUDIO_BLOCK_SAMPLES
+	 */
+	void prepareBlock(uint32_t len)
+	{
+		uint32_t i, w = writeAddr;
+		blk_active = active_get();
+		if (!blk_active)
+		{
+			warmup = BASIC_PITCH_WARMUP_LEN;
+			return;
+		}
+		if (warmup == BASIC_PITCH_WARMUP_LEN) outFilter.reset();
+		for (i = 0; i < len; i++)
+		{
+			readAddr += readAdder;
+			blk_idx[i] = (readAddr >> (32-BASIC_PITCH_BUF_BITS)) & BASIC_PITCH_BUF_MASK;
+			blk_frac[i] = (float)(readAddr & BASIC_PITCH_BUF_FRAC_MASK) / (float)BASIC_PITCH_BUF_FRAC_MASK;
+			blk_xf[i] = xfade_coeff(readAddr - (w<<(32-BASIC_PITCH_BUF_BITS)));
+			w = (w + 1) & BASIC_PITCH_BUF_MASK;
+			if (warmup > BASIC_PITCH_WARMUP_XFADE_LEN) 	blk_wet[i] = 0.0f;	// refill the buffer, dry only
+			else if (warmup)	blk_wet[i] = mix * (float)(BASIC_PITCH_WARMUP_XFADE_LEN - warmup) * (1.0f / BASIC_PITCH_WARMUP_XFADE_LEN);
+			else 				blk_wet[i] = mix;
+			if (warmup) warmup--;
+		}
+	}
+	/**
+	 * @brief process new sample using the values computed by prepareBlock()
+	 * 
+	 * @param newSample input sample
+	 * @param i sample index within the block
+	 * @return float output sample
+	 */
+	inline float processPrepared(float newSample, uint32_t i)
+	{
+		uint32_t idx;
+		float k_frac, s_n, s_half;
+		if (!blk_active) return newSample;
+		bf[writeAddr] = newSample;
+		writeAddr = (writeAddr + 1) & BASIC_PITCH_BUF_MASK;
+		if (blk_wet[i] == 0.0f) return newSample;
+		idx = blk_idx[i];
+		k_frac = blk_frac[i];
+		s_n = read(idx, k_frac);
+		s_half = read((idx + BASIC_PITCH_BUF_SIZE_HALF) & BASIC_PITCH_BUF_MASK, k_frac);
+		s_n = s_half + (s_n - s_half) * blk_xf[i];
+		s_n = outFilter.process(s_n);
+		return (newSample + (s_n - newSample) * blk_wet[i]);
+	}
+	/**
+	 * @brief process a block of samples, feed forward use only
+	 * 
+	 * @param src input buffer
+	 * @param dst output buffer, can be the same as src
+	 * @param len block length, max AUDIO_BLOCK_SAMPLES
+	 */
+	void processBlock(const float *src, float *dst, uint32_t len)
+	{
+		uint32_t i;
+		prepareBlock(len);
+		if (!blk_active)
+		{
+			if (dst != src) memcpy(dst, src, len*sizeof(float));
+			return;
+		}
+		for (i = 0; i < len; i++)
+		{
+			dst[i] = processPrepared(src[i], i);
+		}
 	}
 	void setMix(float mixRatio)
 	{
 		mix = constrain(mixRatio, 0.0f, 1.0f);
 	}
+	/**
+	 * @brief Set the read interpolation method
+	 * 			drop sample is the cheapest one, good enough inside the reverb feedback loops,
+	 * 			Hermite gives the best quality for standalone pitch effects
+	 * 
+	 * @param mode PITCH_INTERP_DROP, PITCH_INTERP_LINEAR or PITCH_INTERP_HERMITE
+	 */
+	void setInterpolation(pitch_interp_t mode)
+	{
+		if (mode <= PITCH_INTERP_HERMITE) interp = mode;
+	}
+	pitch_interp_t getInterpolation() { return interp; }
 	void reset()
 	{
 		memset(bf, 0, BASIC_PITCH_BUF_SIZE*sizeof(float));
@@ -102,13 +200,20 @@ public:
 		writeAddr = 0;
 		readAdder = pitchDelta0;
 		mix = 1.0f;
+		warmup = 0;
 	}
+	/**
+	 * @brief returns true if the pitch shifter is processing the signal,
+	 * 			false if it is disabled (mix = 0 or no pitch change)
+	 */
+	bool active_get() { return (mix != 0.0f && readAdder != pitchDelta0); }
 private:
 	float *bf;
 	float mix;
 	uint32_t readAddr;
 	uint32_t readAdder;
 	uint16_t writeAddr;
+	uint16_t warmup = 0;		// samples left to refill the buffer and fade in after re-enabling
 	static const uint32_t pitchDelta0 = BASIC_PITCH_BUF_FRAC_MASK+1;
 
 	AudioFilterShelvingLPHP outFilter;
@@ -116,6 +221,64 @@ private:
 	const float hp_gain = 0.0f;
 	static constexpr float lp_f = 0.26f;
 	float lp_gain = 1.0f;
+	pitch_interp_t interp = PITCH_INTERP_LINEAR;
+
+	/**
+	 * @brief read the buffer using the set interpolation method
+	 * 
+	 * @param idx integer part of the read position
+	 * @param frac fractional part of the read position
+	 * @return float interpolated sample
+	 */
+	inline float read(uint32_t idx, float frac)
+	{
+		float xm1, x0, x1, x2, c, v, w, a, b_neg;
+		switch(interp)
+		{
+			case PITCH_INTERP_DROP:
+				return bf[idx];
+			case PITCH_INTERP_HERMITE:
+				xm1 = bf[(idx - 1) & BASIC_PITCH_BUF_MASK];
+				x0 = bf[idx];
+				x1 = bf[(idx + 1) & BASIC_PITCH_BUF_MASK];
+				x2 = bf[(idx + 2) & BASIC_PITCH_BUF_MASK];
+				c = (x1 - xm1) * 0.5f;
+				v = x0 - x1;
+				w = c + v;
+				a = w + v + (x2 - x0) * 0.5f;
+				b_neg = w + a;
+				return (((a * frac) - b_neg) * frac + c) * frac + x0;
+			case PITCH_INTERP_LINEAR:
+			default:
+				x0 = bf[idx];
+				return (x0 + (bf[(idx + 1) & BASIC_PITCH_BUF_MASK] - x0) * frac);
+		}
+	}
+
+	// block processing, read positions and crossfade envelope computed by prepareBlock()
+	bool blk_active = false;
+	uint16_t blk_idx[AUDIO_BLOCK_SAMPLES];
+	float blk_frac[AUDIO_BLOCK_SAMPLES];
+	float blk_xf[AUDIO_BLOCK_SAMPLES];
+	float blk_wet[AUDIO_BLOCK_SAMPLES];
+
+	/**
+	 * @brief crossfade coeff for the last sample based on the read - write pointer distance
+	 * 
+	 * @param delta_acc distance between the write and read pointer
+	 * @return float crossfade coeff 
+	 */
+	static inline float xfade_coeff(uint32_t delta_acc)
+	{
+		uint32_t delta, idx;
+		float delta_frac, k;
+		delta = (delta_acc >> (32-9)) & 0x1FF;								// 9 bit value = 2x fade table length (fade in + fade out)
+		delta_frac = (float)(delta_acc & ((1<<23)-1)) / (float)((1<<23)-1);	// fractional part for the xfade curve
+		idx = delta&0xFF;
+		k = AudioWaveformFader_f32[idx] * (1.0f-delta_frac) + AudioWaveformFader_f32[idx+1] * delta_frac;	// interpolated smooth crossfade coeff.
+		if (delta > 0xFF) k = 1.0f-k;										// invert the curve for the fade out part
+		return k;
+	}
 };
 
 
@@ -60,6 +60,41 @@ public:
         hpreg += tmp1 * hp_f;
 		return (lpreg + hidamp*tmp2 + lodamp * hpreg);
 	}
+	/**
+	 * @brief process a block of samples
+	 * 		the params are smoothed per sample only if they are still changing
+	 * 
+	 * @param src input buffer
+	 * @param dst output buffer, can be the same as src
+	 * @param len number of samples
+	 */
+	void processBlock(const float *src, float *dst, uint32_t len)
+	{
+		if (bp)
+		{
+			if (dst != src) memcpy(dst, src, len * sizeof(float));
+			return;
+		}
+		if (hidamp != (*hidampPtr) || lodamp != (*lodampPtr))
+		{
+			while (len--) *dst++ = process(*src++);
+			return;
+		}
+		float in, tmp1, tmp2, lp = lpreg, hp = hpreg;
+		const float hd = hidamp, ld = lodamp;
+		while (len--)
+		{
+			in = *src++;
+			tmp1 = in - lp;
+			lp += tmp1 * lp_f;
+			tmp2 = in - lp;
+			tmp1 = lp - hp;
+			hp += tmp1 * hp_f;
+			*dst++ = lp + hd*tmp2 + ld * hp;
+		}
+		lpreg = lp;
+		hpreg = hp;
+	}
 	void reset()
 	{
 		lpreg = 0.0f;
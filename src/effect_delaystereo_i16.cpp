@@ -29,42 +29,58 @@
 #define BASS_LOSS_FREQ      (0.05f)
 #define BASS_FREQ      		(0.15f)
 #define DLY_TIME_FAILSAFE	(500)
+#define DLY_TIME_SNAP		(0.0001f)	// delay time glide end, in samples
+#define DLY_TAP_TOLERANCE	(0.25f)	// max tap interval deviation from the average
 
 extern uint8_t external_psram_size;
 
-AudioEffectDelayStereo_i16::AudioEffectDelayStereo_i16(uint32_t dly_range_ms, bool use_psram) : AudioStream(2, inputQueueArray)
+AudioEffectDelayStereo_i16::AudioEffectDelayStereo_i16(uint32_t dly_range_ms, bool use_psram, bool long_delay) : AudioStream(2, inputQueueArray)
 {
-	begin(dly_range_ms, use_psram);
+	begin(dly_range_ms, use_psram, long_delay);
 }
 
-void AudioEffectDelayStereo_i16::begin(uint32_t dly_range_ms, bool use_psram)
+void AudioEffectDelayStereo_i16::begin(uint32_t dly_range_ms, bool use_psram, bool long_delay)
 {
 	initialized = false;
+	long_mode = long_delay;
+	// Q15 samples take half the memory, the same buffer size holds twice the delay time
+	uint32_t time_failsafe = long_mode ? 2*DLY_TIME_FAILSAFE : DLY_TIME_FAILSAFE;
+	uint32_t frame_bytes = 4 * (long_mode ? sizeof(int16_t) : sizeof(float32_t));
+	memCleanupStep = 8192 / frame_bytes;
 	// failsafe if psram is required but not found
-	// limit the delay time to 500ms (88200 bytes at 44.1kHz)
+	// limit the delay time to 500ms (1000ms in long delay mode)
 	psram_mode = use_psram;
 	#if ARDUINO_TEENSY41
 	if (psram_mode && external_psram_size == 0)
 	{
 		psram_mode = false;
-		if (dly_range_ms > DLY_TIME_FAILSAFE) dly_range_ms = DLY_TIME_FAILSAFE;
-	}	
+		if (dly_range_ms > time_failsafe) dly_range_ms = time_failsafe;
+	}
+	// limit the delay time to the size of the PSRAM
+	if (psram_mode)
+	{
+		uint32_t time_max = (uint64_t)external_psram_size * 1024u * 1024u / frame_bytes * 1000u / (uint32_t)AUDIO_SAMPLE_RATE_EXACT;
+		if (dly_range_ms > time_max) dly_range_ms = time_max;
+	}
 	#else
 		psram_mode = false;
-		if (dly_range_ms > DLY_TIME_FAILSAFE) dly_range_ms = DLY_TIME_FAILSAFE;	
+		if (dly_range_ms > time_failsafe) dly_range_ms = time_failsafe;	
 	#endif
 	bool memOk = true;
 	dly_length = ((float32_t)(dly_range_ms)/1000.0f) * AUDIO_SAMPLE_RATE_EXACT;	
-	if (!dly0a.init(dly_length, psram_mode)) memOk = false;
-	if (!dly0b.init(dly_length, psram_mode)) memOk = false;
-	if (!dly1a.init(dly_length, psram_mode)) memOk = false;
-	if (!dly1b.init(dly_length, psram_mode)) memOk = false;
+	if (long_mode)
+	{
+		if (!dly_q15.init(dly_length, psram_mode)) memOk = false;
+	}
+	else if (!dly.init(dly_length, psram_mode)) memOk = false;
 	flt0L.init(BASS_LOSS_FREQ, &bassCut_k, TREBLE_LOSS_FREQ, &trebleCut_k);
 	flt1L.init(BASS_LOSS_FREQ, &bass_k, TREBLE_LOSS_FREQ, &treble_k);
 	flt0R.init(BASS_LOSS_FREQ, &bassCut_k, TREBLE_LOSS_FREQ, &trebleCut_k);
 	flt1R.init(BASS_LOSS_FREQ, &bass_k, TREBLE_LOSS_FREQ, &treble_k);
 	mix(0.5f);
 	feedback(0.5f);
+	// the whole delay buffer has to be flushed before going idle
+	idle.init(dly_length / AUDIO_BLOCK_SAMPLES + 1);
 	cleanup_done = true;
 	if (memOk) initialized = true;
 }
@@ -79,13 +95,29 @@ void AudioEffectDelayStereo_i16::update()
 	}
 
 	audio_block_t *blockL, *blockR;
-	int i;
-	float32_t acc1, acc2, inL, inR, outL, outR, mod_fr[4];
+	int i, j;
+	float32_t acc2, mod_fr, wet_peak;
 	uint32_t mod_int;
-	static float32_t dly_time_flt = 0.0f;
+	float32_t dly_ramp[AUDIO_BLOCK_SAMPLES];	// smoothed delay time
+	float32_t rd_pos[4][AUDIO_BLOCK_SAMPLES];	// read positions, replaced with the taps in the block path
+	static const uint8_t lfo_phase[4] = {BASIC_LFO_PHASE_0, BASIC_LFO_PHASE_60, BASIC_LFO_PHASE_120, BASIC_LFO_PHASE_180};
 
 	blockL = receiveWritable(0);
 	blockR = receiveWritable(1);
+	// auto idle: silent input and decayed echoes, skip the processing, no blocks transmitted
+	// input blocks in TRAILS bypass mode are discarded, treat them as silence
+	if (autoIdle && (!bp || bp_mode == BYPASS_MODE_TRAILS))
+	{
+		if (idle.skip(bp ? NULL : blockL, bp ? NULL : blockR))
+		{
+			if (blockL) release(blockL);
+			if (blockR) release(blockR);
+			// nothing to glide over, resume with the new delay time
+			dly_time = dly_time_flt = dly_time_set;
+			lfo.update(AUDIO_BLOCK_SAMPLES);
+			return;
+		}
+	}
 	if (!bypass_process(&blockL, &blockR, bp_mode, bp))
 		return;
 
@@ -96,7 +128,6 @@ void AudioEffectDelayStereo_i16::update()
 		{
 			cleanup_done = memCleanup();
 			tap_active = false;	// reset tap tempo
-			tap_counter = 0;
 		}
 		if (infinite) freeze(false);
 		if (bp_mode != BYPASS_MODE_TRAILS)
@@ -111,103 +142,255 @@ void AudioEffectDelayStereo_i16::update()
 		{
 			inputGainSet = 0.0f;
 			tap_active = false;	// reset tap tempo
-			tap_counter = 0;		
 		}
 	}
 
 	cleanup_done = false;
 
+	// delay time glide for the whole block, then the modulation and read positions
+	timeRamp(dly_ramp);
 	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
     {  
-		inputGain += (inputGainSet - inputGain) * 0.25f;
-		// tap tempo
-		if (tap_active)
+		lfo.update();
+		for (j = 0; j < 4; j++)
 		{
-			if (++tap_counter > tap_counter_max)
-			{
-				tap_active = false;
-				tap_counter = 0;
-			}
+			lfo.get(lfo_phase[j], &mod_int, &mod_fr);
+			mod_fr = (float32_t)mod_int + mod_fr;
+			acc2 = (float32_t)dly_length - 1.0f - (dly_ramp[i] + mod_fr);
+			if (acc2 < 0.0f) mod_fr += acc2;
+			rd_pos[j][i] = dly_ramp[i] + mod_fr;
 		}
+	}
+	if (long_mode)	wet_peak = processLines(dly_q15, blockL, blockR, rd_pos);
+	else 			wet_peak = processLines(dly, blockL, blockR, rd_pos);
+	if (autoIdle) idle.update(wet_peak);
+    transmit(blockL, 0);
+	transmit(blockR, 1);
+	release(blockL);
+	release(blockR);
+}
+/**
+ * @brief delay time trajectory for one block.
+ * 		The delay time glides with the inertia set slew rate towards the new setting,
+ * 		followed by a lowpass filter. Once settled, the time is held constant and
+ * 		the per sample smoothing is skipped.
+ * 
+ * @param ramp output, delay time for each sample in the block
+ */
+void AudioEffectDelayStereo_i16::timeRamp(float32_t *ramp)
+{
+	int i;
+	const float32_t t_set = dly_time_set, step = dly_time_step;
+	// glide computed as the distance to the target, keeps the resolution of
+	// the small steps at long delay times
+	float32_t e = dly_time - t_set, e_flt = dly_time_flt - t_set;
 
-		if (dly_time < dly_time_set)
+	if (e == 0.0f && e_flt == 0.0f)
+	{
+		for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) ramp[i] = t_set;
+		return;
+	}
+	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+	{
+		if (e < 0.0f)
 		{
-			dly_time += dly_time_step;
-			if (dly_time > dly_time_set) dly_time = dly_time_set;
+			e += step;
+			if (e > 0.0f) e = 0.0f;
 		}
-		if (dly_time > dly_time_set)
+		else if (e > 0.0f)
 		{
-			dly_time -= dly_time_step;
-			if (dly_time < dly_time_set) dly_time = dly_time_set;
+			e -= step;
+			if (e < 0.0f) e = 0.0f;
 		}
 		// lowpass the delay time
-		acc1 = dly_time - dly_time_flt;
-		dly_time_flt += acc1 * 0.1f;
-		dly_time = dly_time_flt;
-
-		lfo.update();
-
-		lfo.get(BASIC_LFO_PHASE_0, &mod_int, &mod_fr[0]);
-		mod_fr[0] = (float32_t)mod_int + mod_fr[0];
-		acc2 = (float32_t)dly_length - 1.0f - (dly_time + mod_fr[0]);
-		if (acc2 < 0.0f) mod_fr[0] += acc2;
-
-		lfo.get(BASIC_LFO_PHASE_60, &mod_int, &mod_fr[1]);
-		mod_fr[1] = (float32_t)mod_int + mod_fr[1];
-		acc2 = (float32_t)dly_length - 1.0f - (dly_time + mod_fr[1]);
-		if (acc2 < 0.0f) mod_fr[1] += acc2;
-
-		lfo.get(BASIC_LFO_PHASE_120, &mod_int, &mod_fr[2]);
-		mod_fr[2] = (float32_t)mod_int + mod_fr[2];
-		acc2 = (float32_t)dly_length - 1.0f - (dly_time + mod_fr[2]);
-		if (acc2 < 0.0f) mod_fr[2] += acc2;	
+		e_flt += (e - e_flt) * 0.1f;
+		e = e_flt;
+		ramp[i] = t_set + e;
+	}
+	if (fabsf(e) < DLY_TIME_SNAP) e = 0.0f;
+	dly_time = dly_time_flt = t_set + e;
+}
 
-		lfo.get(BASIC_LFO_PHASE_180, &mod_int, &mod_fr[3]);
-		mod_fr[3] = (float32_t)mod_int + mod_fr[3];	
-		acc2 = (float32_t)dly_length - 1.0f - (dly_time + mod_fr[3]);
-		if (acc2 < 0.0f) mod_fr[3] += acc2;		
+/**
+ * @brief read the taps, process the feedback paths and write the 4 delay lines
+ * 
+ * @param d 		delay lines, float or Q15 (long delay mode)
+ * @param blockL 	audio block L, replaced with the output
+ * @param blockR 	audio block R, replaced with the output
+ * @param rd_pos 	read positions for the whole block
+ * @return float32_t peak level of the delay taps (wet signal) in the block
+ */
+template <typename T>
+float32_t AudioEffectDelayStereo_i16::processLines(AudioBasicDelayMulti<4, T> &d, audio_block_t *blockL, audio_block_t *blockR, float32_t (*rd_pos)[AUDIO_BLOCK_SAMPLES])
+{
+	int i, j;
+	float32_t acc1, acc2, inL, inR, outL, outR, pos_fr;
+	float32_t wet_peak = 0.0f;
+	int32_t pos_int;
+	float32_t frame[4], x[4];
+	const T *frames, *p;
+	int32_t read_start;
 
+	// none of the reads may touch the samples written in this block and the read region 
+	// must not wrap around the buffer end, then the taps are read directly from the frames
+	frames = readRegion(d, rd_pos, &read_start);
+	if (frames)
+	{
+		for (j = 0; j < 4; j++)
+		{
+			for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+			{
+				pos_int = static_cast<int32_t>(rd_pos[j][i]);
+				pos_fr = rd_pos[j][i] - static_cast<float32_t>(pos_int);
+				p = &frames[(i + pos_int - 1 - read_start) * 4 + j];
+				x[0] = d.toFloat(p[0]);
+				x[1] = d.toFloat(p[4]);
+				x[2] = d.toFloat(p[8]);
+				x[3] = d.toFloat(p[12]);
+				rd_pos[j][i] = AudioBasicDelay::interpHermite(x, pos_fr);
+			}
+		}
+	}
+	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+	{
+		if (!frames)
+		{
+			// reads overlap the current block (shortest delay times) or the buffer end, read per sample
+			for (j = 0; j < 4; j++)	rd_pos[j][i] = d.getTapHermite(j, rd_pos[j][i]);
+		}
+		inputGain += (inputGainSet - inputGain) * 0.25f;
 		inL = (float32_t)blockL->data[i] / 32768.0f;
 		inR = (float32_t)blockR->data[i] / 32768.0f; 
 
-		acc1 = dly0b.getTapHermite(dly_time+mod_fr[0]);
+		acc1 = rd_pos[DLY_0B][i];
 		outR = acc1 * 0.6f;
 		acc1 = flt0R.process(acc1) * feedb;
 		acc1 += inR * inputGain;
-		acc1 = flt1R.process(acc1);
-		acc2 = dly0a.getTapHermite(dly_time+mod_fr[1]);
-		dly0b.write_toOffset(acc2, 0);
+		frame[DLY_0A] = flt1R.process(acc1);
+		acc2 = rd_pos[DLY_0A][i];
+		frame[DLY_0B] = acc2;
 		outL = acc2 * 0.6f;
-		dly0a.write_toOffset(acc1, 0);
 
-		acc1 = dly1b.getTapHermite(dly_time+mod_fr[2]);
+		acc1 = rd_pos[DLY_1B][i];
 		outR += acc1 * 0.6f;
 		acc1 = flt0L.process(acc1) * feedb;
 		acc1 += inL * inputGain;
-		acc1 = flt1L.process(acc1);
-		acc2 = dly1a.getTapHermite(dly_time+mod_fr[3]);
-		dly1b.write_toOffset(acc2, 0);
+		frame[DLY_1A] = flt1L.process(acc1);
+		acc2 = rd_pos[DLY_1A][i];
+		frame[DLY_1B] = acc2;
 		outL += acc2 * 0.6f;
-		dly1a.write_toOffset(acc1, 0);
 
-		dly0a.updateIndex();
-		dly0b.updateIndex();
-		dly1a.updateIndex();
-		dly1b.updateIndex();
-		if (outL > 1.0f) 		outL = 1.0f;
-		else if (outL < -1.0f) 	outL = -1.0f;
-		if (outR > 1.0f)		outR = 1.0f;
-		else if (outR < -1.0f) 	outR = -1.0f;
-		
-		blockL->data[i] = (int16_t)((outL * wet_gain + inL * dry_gain) * 32767.0f);
-		blockR->data[i] = (int16_t)((outR * wet_gain + inR * dry_gain) * 32767.0f);
+		d.write(frame);
+		d.updateIndex();
 
+		wet_peak = fmaxf(wet_peak, fmaxf(fabsf(outL), fabsf(outR)));
+		blockL->data[i] = outputMix(outL, inL);
+		blockR->data[i] = outputMix(outR, inR);
 	}
-    transmit(blockL, 0);
-	transmit(blockR, 1);
-	release(blockL);
-	release(blockR);
+	return wet_peak;
+}
+
+/**
+ * @brief find the frames read by all 4 lines in the current block.
+ * 		The taps can be read before the block is written if no read (incl. the hermite 
+ * 		neighbours) touches the samples written in the current block.
+ * 
+ * @param dl 	delay lines
+ * @param pos 	read positions for the 4 delay lines
+ * @param start first frame of the region, relative to the write index 
+ * @return pointer to the first frame, NULL if the reads have to be done per sample 
+ */
+template <typename T>
+const T* AudioEffectDelayStereo_i16::readRegion(AudioBasicDelayMulti<4, T> &dl, const float32_t (*pos)[AUDIO_BLOCK_SAMPLES], int32_t *start)
+{
+	int32_t d, d_min, p, p_min, p_max;
+	d_min = p_min = p_max = static_cast<int32_t>(pos[0][0]);
+	for (int j = 0; j < 4; j++)
+	{
+		for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+		{
+			d = static_cast<int32_t>(pos[j][i]);
+			p = i + d;
+			if (d < d_min) d_min = d;
+			if (p < p_min) p_min = p;
+			if (p > p_max) p_max = p;
+		}
+	}
+	// xm1 of the sample i must not be older than i, x2 must stay before the wrap-around
+	if (d_min < 1 || p_max + 2 >= (int32_t)dly_length) return NULL;
+	*start = p_min - 1;
+	return dl.getFrames(*start, p_max - p_min + 4);
+}
+
+uint32_t AudioEffectDelayStereo_i16::tap_tempo(bool avg)
+{
+	uint32_t now = micros();
+	uint32_t dt, mean, i;
+
+	dt = now - tap_time_last;
+	tap_time_last = now;
+	if (!tap_active || dt > tap_timeout_us)	// first tap, start a new measurement
+	{
+		tap_active = true;
+		tap_count = 0;
+		tap_outlier = 0;
+		return 0;
+	}
+	if (!avg) tap_count = 0;
+	if (tap_count)
+	{
+		mean = 0;
+		for (i = 0; i < tap_count; i++) mean += tap_intervals[i];
+		mean /= tap_count;
+		if (abs((int32_t)(dt - mean)) > (int32_t)(mean * DLY_TAP_TOLERANCE))
+		{
+			// a single stray or missed tap is ignored
+			// two similar intervals in a row replace the tempo
+			if (!tap_outlier || abs((int32_t)(dt - tap_outlier)) > (int32_t)(tap_outlier * DLY_TAP_TOLERANCE))
+			{
+				tap_outlier = dt;
+				return 0;
+			}
+			tap_count = 0;
+			tap_intervals[0] = tap_outlier;
+			tap_idx = tap_count = 1;
+		}
+	}
+	tap_outlier = 0;
+	if (tap_count == 0) tap_idx = 0;
+	tap_intervals[tap_idx] = dt;
+	if (++tap_idx >= DLY_TAP_AVG_MAX) tap_idx = 0;
+	if (tap_count < DLY_TAP_AVG_MAX) tap_count++;
+	mean = 0;
+	for (i = 0; i < tap_count; i++) mean += tap_intervals[i];
+	tap_period_us = mean / tap_count;
+	return tap_apply();
+}
+
+void AudioEffectDelayStereo_i16::tap_subdiv(tap_subdiv_t div)
+{
+	if (div >= TAP_DIV_LAST) return;
+	tap_div = div;
+	if (tap_period_us) tap_apply();
+}
+/**
+ * @brief convert the tapped tempo to the delay time, apply the subdivision
+ * 		and halve the time until it fits into the delay buffer
+ * 
+ * @return uint32_t delay time in samples
+ */
+uint32_t AudioEffectDelayStereo_i16::tap_apply()
+{
+	static const float32_t div_k[TAP_DIV_LAST] = {1.0f, 1.5f, 2.0f/3.0f, 0.5f, 0.75f, 1.0f/3.0f, 0.25f};
+	uint32_t ticks = (float32_t)tap_period_us * (AUDIO_SAMPLE_RATE_EXACT / 1.0e6f) * div_k[tap_div];
+	while (ticks > dly_length - dly_time_min)
+	{
+		ticks >>= 1;
+	}
+	delay(ticks);
+	return ticks;
 }
+
 void AudioEffectDelayStereo_i16::freeze(bool state)
 {
 	if (infinite == state) return;
@@ -252,78 +435,22 @@ void AudioEffectDelayStereo_i16::freeze(bool state)
  */
 bool AudioEffectDelayStereo_i16::memCleanup()
 {
-
-	static uint8_t dlyIdx = 0;
-	bool result = false;
-	if (dlyIdx == 0) // value 0 is used to reset the addr
+	if (memCleanupStart == 0)
 	{
-		memCleanupStart = 0;
-		memCleanupEnd = memCleanupStep;
 		flt0L.reset();
 		flt0R.reset();
 		flt1L.reset();
 		flt1R.reset();
-		dlyIdx = 1;
 	}
-	if (memCleanupEnd > dly_length) 		// last segment
+	if (long_mode)	dly_q15.reset(memCleanupStart, memCleanupStart + memCleanupStep);
+	else			dly.reset(memCleanupStart, memCleanupStart + memCleanupStep);
+	memCleanupStart += memCleanupStep;
+	if (memCleanupStart >= dly_length)
 	{
-		memCleanupEnd = dly_length;
-		result = true;
+		memCleanupStart = 0;
+		return true;
 	}
-	switch(dlyIdx)
-	{
-		case 1:
-			dly0a.reset(memCleanupStart, memCleanupEnd);
-			memCleanupStart = memCleanupEnd;
-			memCleanupEnd += memCleanupStep;
-			if (result) // if done, reset the mem addr
-			{
-				memCleanupStart = 0;
-				memCleanupEnd = memCleanupStep;
-				dlyIdx = 2;
-				result = false;
-			}
-			break;
-		case 2:
-			dly0b.reset(memCleanupStart, memCleanupEnd);
-			memCleanupStart = memCleanupEnd;
-			memCleanupEnd += memCleanupStep;			
-			if (result) // if done, reset the mem addr
-			{
-				memCleanupStart = 0;
-				memCleanupEnd = memCleanupStep;
-				dlyIdx = 3;
-				result = false;
-			}		
-			break;
-		case 3:
-			dly1a.reset(memCleanupStart, memCleanupEnd);
-			memCleanupStart = memCleanupEnd;
-			memCleanupEnd += memCleanupStep;			
-			if (result) // if done, reset the mem addr
-			{
-				memCleanupStart = 0;
-				memCleanupEnd = memCleanupStep;
-				dlyIdx = 4;
-				result = false;
-			}	
-			break;
-		case 4:
-			dly1b.reset(memCleanupStart, memCleanupEnd);
-			memCleanupStart = memCleanupEnd;
-			memCleanupEnd += memCleanupStep;			
-			if (result) // if done, reset the mem addr
-			{
-				dlyIdx = 0;
-				result = true;
-			}				
-			break;
-		default:
-			dlyIdx = 0; // cleanup done, reset the dly line idx
-			result = false;
-			break;
-	}	
-	return result;
+	return false;
 }
 
 bool AudioEffectDelayStereo_i16::bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state)
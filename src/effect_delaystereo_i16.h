@@ -32,10 +32,35 @@
 #include "arm_math.h"
 #include "basic_components.h"
 
+#ifndef DLY_TAP_AVG_MAX
+	#define DLY_TAP_AVG_MAX		(4)		// number of tap intervals averaged
+#endif
+
+// tap tempo subdivisions
+typedef enum
+{
+	TAP_DIV_1_4,			// quarter note, delay = tapped interval
+	TAP_DIV_1_4_DOTTED,
+	TAP_DIV_1_4_TRIPLET,
+	TAP_DIV_1_8,
+	TAP_DIV_1_8_DOTTED,
+	TAP_DIV_1_8_TRIPLET,
+	TAP_DIV_1_16,
+	TAP_DIV_LAST
+}tap_subdiv_t;
+
 class AudioEffectDelayStereo_i16 : public AudioStream
 {
 public:
-	AudioEffectDelayStereo_i16(uint32_t dly_range_ms=400, bool use_psram=false);
+	/**
+	 * @brief Construct a new stereo delay
+	 * 
+	 * @param dly_range_ms 	max delay time in ms
+	 * @param use_psram 	place the delay buffer in PSRAM
+	 * @param long_delay 	long delay (looper) mode, the delay lines are stored as int16_t,
+	 * 						twice the delay time for the same memory, tens of seconds with PSRAM
+	 */
+	AudioEffectDelayStereo_i16(uint32_t dly_range_ms=400, bool use_psram=false, bool long_delay=false);
 	~AudioEffectDelayStereo_i16(){};
 	virtual void update();
 	/**
@@ -223,7 +248,6 @@ public:
 		{
 			__disable_irq();
 			memCleanupStart = 0;
-			memCleanupEnd = memCleanupStep;
 			__enable_irq();
 			freeze(false);
 		}
@@ -239,51 +263,76 @@ public:
 		bypass_set(bp ^ 1);
         return bp;
     }
+	/**
+	 * @brief enables the automatic idle mode. If the input is silent and the echoes
+	 * 		have decayed below the threshold, the processing is skipped and no audio blocks
+	 * 		are transmitted. The first non silent input block resumes the processing.
+	 * 
+	 * @param state true = enabled
+	 */
+	void autoIdle_set(bool state)
+	{
+		__disable_irq();
+		autoIdle = state;
+		idle.reset();
+		__enable_irq();
+	}
+	bool autoIdle_get() {return autoIdle;}
+	/**
+	 * @brief sets the silence threshold used by the auto idle mode
+	 * 
+	 * @param thr max absolute sample value treated as silence
+	 */
+	void autoIdle_threshold(int16_t thr)
+	{
+		__disable_irq();
+		idle.threshold(thr);
+		__enable_irq();
+	}
+	bool idle_get() {return idle.get();}
 	void freeze(bool state);
     bool freeze_tgl() {freeze(infinite^1); return infinite;}
     bool freeze_get() {return infinite;}
-	uint32_t tap_tempo(bool avg=true)
-	{
-		int32_t delta;
-		uint32_t tempo_ticks = 0;
-		if (!tap_active)
-		{
-			tap_counter = 0;
-			tap_active = true;
-		} 
-		else
-		{
-			__disable_irq();
-			tap_counter_new = tap_counter;
-			tap_counter = 0;
-			__enable_irq();
-			delta = tap_counter_new - tap_counter_last;
-			if (abs(delta) > tap_counter_deltamax || !avg) // new tempo?
-			{
-				tempo_ticks = tap_counter_new;
-			}
-			else 
-			{
-				tempo_ticks = (tap_counter_new>>1) + (tap_counter_last>>1);
-			}
-			while (tempo_ticks > dly_length - dly_time_min)
-			{
-				tempo_ticks >>= 1;
-			}
-			tap_counter_last = tempo_ticks;
-			delay(tempo_ticks);
-		}
-		return tempo_ticks;
-	}
+	/**
+	 * @brief tap tempo, call on every tap. The intervals are timestamped with micros(),
+	 * 		the tempo is the average of the last DLY_TAP_AVG_MAX taps. A single stray tap
+	 * 		is ignored, two similar intervals in a row set a new tempo.
+	 * 		Taps more than 3 seconds apart start a new measurement.
+	 * 
+	 * @param avg average the intervals, false = use the last interval only
+	 * @return uint32_t new delay time in samples, 0 if not changed
+	 */
+	uint32_t tap_tempo(bool avg=true);
+	/**
+	 * @brief tempo subdivision applied to the tapped tempo
+	 * 
+	 * @param div one of the tap_subdiv_t values, default TAP_DIV_1_4
+	 */
+	void tap_subdiv(tap_subdiv_t div);
+	tap_subdiv_t tap_subdiv_get() {return tap_div;}
+	/**
+	 * @brief last tapped tempo 
+	 * 
+	 * @return float32_t tempo in BPM, 0 if not tapped yet
+	 */
+	float32_t tap_bpm_get() {return tap_period_us ? 60.0e6f / (float32_t)tap_period_us : 0.0f;}
 	bool is_initialized() {return initialized;}
+	bool long_delay_get() {return long_mode;}
+	/**
+	 * @brief max delay time after the memory limits were applied 
+	 * 
+	 * @return uint32_t delay range in ms
+	 */
+	uint32_t delay_range_get() {return (uint32_t)((float32_t)dly_length * 1000.0f / AUDIO_SAMPLE_RATE_EXACT);}
 private:
 	audio_block_t *inputQueueArray[2];
 
 	uint32_t dly_length;
-	AudioBasicDelay dly0a;
-	AudioBasicDelay dly0b;
-	AudioBasicDelay dly1a;
-	AudioBasicDelay dly1b;
+	// 4 interleaved delay lines, ping-pong pairs 0 (R input) and 1 (L input)
+	enum {DLY_0B, DLY_0A, DLY_1B, DLY_1A};
+	AudioBasicDelayMulti<4> dly;
+	AudioBasicDelayMulti<4, int16_t> dly_q15;		// long delay mode
+	bool long_mode = false;
 	
 	AudioFilterShelvingLPHP flt0L;
 	AudioFilterShelvingLPHP flt1L;
@@ -301,6 +350,8 @@ private:
 	bool cleanup_done = false;
 	bool infinite = false;
 	bool extInputMode = false; // external input via pointers passed to constructor
+	bool autoIdle = false;
+	AudioBasicIdle idle;
 
 	static constexpr float32_t feedb_max = 0.96f;
 	float32_t feedb = 0;
@@ -313,7 +364,8 @@ private:
 	float32_t bassCut_k = 0.0f;
 	float32_t treble_k = 1.0f;
 	float32_t bass_k = 0.0f;
-	float32_t dly_time, dly_time_set;
+	float32_t dly_time = 0.0f, dly_time_set = 0.0f;
+	float32_t dly_time_flt = 0.0f;		// lowpass filtered delay time
 	float32_t dly_time_step = 10.0f;
 	static const uint32_t dly_time_min = 128;
 	bool initialized = false;
@@ -326,16 +378,31 @@ private:
 	float32_t feedb_tmp = 0;
 
 	bool tap_active = false;
-	uint32_t tap_counter = 0;
-	uint32_t tap_counter_last=0, tap_counter_new=0;
-	static const uint32_t tap_counter_max = 3000*AUDIO_SAMPLE_RATE; // 3 sec
-	static const int32_t tap_counter_deltamax = 0.3f*AUDIO_SAMPLE_RATE_EXACT;
+	uint32_t tap_time_last = 0;						// last tap timestamp in us
+	uint32_t tap_intervals[DLY_TAP_AVG_MAX];		// last tap intervals in us
+	uint32_t tap_count = 0;
+	uint32_t tap_idx = 0;
+	uint32_t tap_outlier = 0;						// rejected interval, 0 = none
+	uint32_t tap_period_us = 0;						// averaged tempo
+	tap_subdiv_t tap_div = TAP_DIV_1_4;
+	static const uint32_t tap_timeout_us = 3000000;	// 3 sec
+	uint32_t tap_apply();
 
 	bool memCleanup(void);
-	void begin(uint32_t dly_range_ms, bool use_psram);
-	const uint32_t memCleanupStep = 2048;
+	void timeRamp(float32_t *ramp);
+	template <typename T>
+	float32_t processLines(AudioBasicDelayMulti<4, T> &d, audio_block_t *blockL, audio_block_t *blockR, float32_t (*rd_pos)[AUDIO_BLOCK_SAMPLES]);
+	template <typename T>
+	const T* readRegion(AudioBasicDelayMulti<4, T> &dl, const float32_t (*pos)[AUDIO_BLOCK_SAMPLES], int32_t *start);
+	inline int16_t outputMix(float32_t wet, float32_t dry)
+	{
+		if (wet > 1.0f) 		wet = 1.0f;
+		else if (wet < -1.0f) 	wet = -1.0f;
+		return (int16_t)((wet * wet_gain + dry * dry_gain) * 32767.0f);
+	}
+	void begin(uint32_t dly_range_ms, bool use_psram, bool long_delay);
+	uint32_t memCleanupStep = 512;	// frames of 4 samples, 8kB per update
 	uint32_t memCleanupStart = 0;
-	uint32_t memCleanupEnd = memCleanupStep;
 
 	bool bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state);
 };
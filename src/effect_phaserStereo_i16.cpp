@@ -42,8 +42,10 @@ extern const uint16_t AudioWaveformHyperTri[];
 
 AudioEffectPhaserStereo_i16::AudioEffectPhaserStereo_i16() : AudioStream(3, inputQueueArray)
 {
-	memset(allpass_x, 0, PHASER_STEREO_STAGES * sizeof(float32_t) * 2);
-	memset(allpass_y, 0, PHASER_STEREO_STAGES * sizeof(float32_t) * 2);
+	memset(allpass_y, 0, sizeof(allpass_y));
+	memset(allpass_in, 0, sizeof(allpass_in));
+    last_sampleL = 0.0f;
+    last_sampleR = 0.0f;
     bp = false;
     lfo_phase_acc = 0;
     lfo_add = 0;
@@ -63,17 +65,6 @@ void AudioEffectPhaserStereo_i16::update()
 #if defined(__IMXRT1062__)
     audio_block_t *blockL, *blockR; 
     const audio_block_t *blockMod;    // inputs
-    bool internalLFO = false;                    // use internal LFO of no modulation input
-    uint16_t i = 0;
-    float32_t modSigL, modSigR;
-    uint32_t phaseAcc = lfo_phase_acc;
-    uint32_t phaseAdd = lfo_add;
-    float32_t _lfo_scaler = lfo_scaler;
-    float32_t _lfo_bias = lfo_bias;
-    uint32_t y0, y1, fract;
-    uint64_t y;
-    float32_t inSigL, drySigL, inSigR, drySigR;
-    float32_t fdb = feedb;
 
     blockL = receiveWritable(0);       // audio data
     blockR = receiveWritable(1);       // audio data
@@ -88,12 +79,63 @@ void AudioEffectPhaserStereo_i16::update()
 		release(blockR);
 		return;
 	}
-    blockMod = receiveReadOnly(2);      // bipolar/int16_t control input
-    if (!blockMod)  internalLFO = true;         // no modulation input provided -> use internal LFO
+    blockMod = receiveReadOnly(2);      // bipolar/int16_t control input, NULL -> use internal LFO
+
+    // stage count as template parameter, the cascade is fully unrolled
+    switch (stg)
+    {
+        case 2:     processStages<2>(blockL, blockR, blockMod);     break;
+        case 4:     processStages<4>(blockL, blockR, blockMod);     break;
+        case 6:     processStages<6>(blockL, blockR, blockMod);     break;
+        case 8:     processStages<8>(blockL, blockR, blockMod);     break;
+        case 10:    processStages<10>(blockL, blockR, blockMod);    break;
+        default:    processStages<PHASER_STEREO_STAGES>(blockL, blockR, blockMod);  break;
+    }
+    transmit(blockL, 0);
+    transmit(blockR, 1);
+	release(blockL);
+    release(blockR);
+    if (blockMod) release((audio_block_t *)blockMod);
+#endif
+
+
+}
 
+/**
+ * @brief process one block with the given number of stages.
+ *      Both channels are processed as a 2 lane vector, the allpass stage outputs
+ *      are stored as interleaved L/R pairs. The input of each stage is the previous
+ *      output of the stage above, only the outputs have to be stored.
+ * 
+ * @tparam N        number of stages
+ * @param blockL    audio block L, replaced with the output
+ * @param blockR    audio block R, replaced with the output
+ * @param blockMod  modulation input, NULL = internal LFO
+ */
+template <int N>
+void AudioEffectPhaserStereo_i16::processStages(audio_block_t *blockL, audio_block_t *blockR, const audio_block_t *blockMod)
+{
+    int i, k, c;
+    uint32_t phaseAcc = lfo_phase_acc;
+    const uint32_t phaseAdd = lfo_add;
+    const float32_t _lfo_scaler = lfo_scaler;
+    const float32_t _lfo_bias = lfo_bias;
+    uint32_t y0, y1, fract;
+    uint64_t y;
+    float32_t mod[2], in[2], dry[2];
+    float32_t st[N][2];                         // allpass outputs
+    float32_t acc[N][2];
+    float32_t last[2] = {last_sampleL, last_sampleR};
+    float32_t x_in[2] = {allpass_in[0], allpass_in[1]};
+    const float32_t fdb = feedb;
+    const float32_t in_gain = 1.0f - abs(fdb)*0.25f;    // attenuate the input if using feedback
+    const float32_t wet_k = mix_ratio;
+    const float32_t dry_k = 1.0f - mix_ratio;
+
+    memcpy(st, allpass_y, sizeof(st));
 	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
     {
-        if(internalLFO)
+        if(!blockMod)
         {
             uint32_t LUTaddr = phaseAcc >> LFO_INTERP_INT_SHIFT;	//8 bit address
             fract = phaseAcc & LFO_INTERP_FRACT_MASK;				// fractional part mask
@@ -101,7 +143,7 @@ void AudioEffectPhaserStereo_i16::update()
             y1 = AudioWaveformHyperTri[LUTaddr+1];
             y = ((int64_t) y0 * (LFO_INTERP_FRACT_MASK - fract));
             y += ((int64_t) y1 * (fract));
-            modSigL = (float32_t)(y>>LFO_INTERP_INT_SHIFT) / 65535.0f;
+            mod[0] = (float32_t)(y>>LFO_INTERP_INT_SHIFT) / 65535.0f;
             if (lfo_lroffset)
             {
                 LUTaddr = (LUTaddr + lfo_lroffset) & LFO_LUT_SIZE_MASK;
@@ -109,65 +151,64 @@ void AudioEffectPhaserStereo_i16::update()
                 y1 = AudioWaveformHyperTri[LUTaddr+1];
                 y = ((int64_t) y0 * (LFO_INTERP_FRACT_MASK - fract));
                 y += ((int64_t) y1 * (fract));
-                modSigR = (float32_t)(y>>LFO_INTERP_INT_SHIFT) / 65535.0f;               
+                mod[1] = (float32_t)(y>>LFO_INTERP_INT_SHIFT) / 65535.0f;               
             }
-            else    modSigR = modSigL;
+            else    mod[1] = mod[0];
 
             phaseAcc += phaseAdd;
         }
         else    // external modulation signal does not use modulation offset between LR 
         {
-            modSigL = ((float32_t)blockMod->data[i] + 32768.0f) / 65535.0f;    // mod signal is 0.0 to 1.0
-            modSigR = modSigL;  
+            mod[0] = ((float32_t)blockMod->data[i] + 32768.0f) / 65535.0f;    // mod signal is 0.0 to 1.0
+            mod[1] = mod[0];  
         }
-        // apply scale/offset to the modulation wave
-        modSigL = modSigL * _lfo_scaler + _lfo_bias;
-        modSigR = modSigR * _lfo_scaler + _lfo_bias;
-
-        drySigL = ((float32_t)blockL->data[i] / 32768.0f) * (1.0f - abs(fdb)*0.25f);  // attenuate the input if using feedback
-        inSigL = drySigL + last_sampleL * fdb;
-        drySigR = ((float32_t)blockR->data[i] / 32768.0f)  * (1.0f - abs(fdb)*0.25f);
-        inSigR = drySigR + last_sampleR * fdb;
-
-        y0 = stg;
-        while (y0)  // process allpass filters in pairs
+        dry[0] = ((float32_t)blockL->data[i] / 32768.0f) * in_gain;
+        dry[1] = ((float32_t)blockR->data[i] / 32768.0f) * in_gain;
+        for (c = 0; c < 2; c++)
         {
-            y0--;
-		    allpass_y[0][y0] = modSigL * (allpass_y[0][y0] + inSigL) - allpass_x[0][y0];    // left channel
-		    allpass_x[0][y0] = inSigL;
-		    allpass_y[1][y0] = modSigR * (allpass_y[1][y0] + inSigR) - allpass_x[1][y0];    // right channel
-		    allpass_x[1][y0] = inSigR;
-            y0--;
-		    allpass_y[0][y0] = modSigL * (allpass_y[0][y0] + allpass_y[0][y0+1]) - allpass_x[0][y0];
-		    allpass_x[0][y0] = allpass_y[0][y0+1];
-            inSigL = allpass_y[0][y0];
-            allpass_y[1][y0] = modSigR * (allpass_y[1][y0] + allpass_y[1][y0+1]) - allpass_x[1][y0];
-		    allpass_x[1][y0] = allpass_y[1][y0+1];
-            inSigR = allpass_y[1][y0];
+            // apply scale/offset to the modulation wave
+            mod[c] = mod[c] * _lfo_scaler + _lfo_bias;
+            in[c] = dry[c] + last[c] * fdb;
         }
-		if (inSigL > 1.0f) 			inSigL = 1.0f;
-		else if (inSigL < -1.0f) 	inSigL = -1.0f;
-		if (inSigR > 1.0f)			inSigR = 1.0f;
-		else if (inSigR < -1.0f) 	inSigR = -1.0f;
-
-        last_sampleL = inSigL;
-        last_sampleR = inSigR;
-        blockL->data[i] = (int16_t)((drySigL * (1.0f - mix_ratio) + last_sampleL * mix_ratio) * 32767.0f) ;     // dry/wet mixer
-        blockR->data[i] = (int16_t)((drySigR * (1.0f - mix_ratio) + last_sampleR * mix_ratio) * 32767.0f);     // dry/wet mixer
-
+        // y[k] = m * (y[k] + in[k]) - in_prev[k] = m * in[k] + (m * y[k] - in_prev[k])
+        // the part depending on the previous outputs only is computed first,
+        // one multiply-add per stage remains in the chain through the cascade
+        #pragma GCC unroll 12
+        for (k = N-1; k >= 0; k--)
+        {
+            for (c = 0; c < 2; c++)
+            {
+                acc[k][c] = mod[c] * st[k][c] - (k == N-1 ? x_in[c] : st[k+1][c]);
+            }
+        }
+        x_in[0] = in[0];
+        x_in[1] = in[1];
+        #pragma GCC unroll 12
+        for (k = N-1; k >= 0; k--)
+        {
+            for (c = 0; c < 2; c++)
+            {
+                st[k][c] = mod[c] * in[c] + acc[k][c];
+                in[c] = st[k][c];
+            }
+        }
+        for (c = 0; c < 2; c++)
+        {
+            if (in[c] > 1.0f)           in[c] = 1.0f;
+            else if (in[c] < -1.0f)     in[c] = -1.0f;
+            last[c] = in[c];
+        }
+        blockL->data[i] = (int16_t)((dry[0] * dry_k + last[0] * wet_k) * 32767.0f);     // dry/wet mixer
+        blockR->data[i] = (int16_t)((dry[1] * dry_k + last[1] * wet_k) * 32767.0f);
     }
+    memcpy(allpass_y, st, sizeof(st));
+    allpass_in[0] = x_in[0];
+    allpass_in[1] = x_in[1];
+    last_sampleL = last[0];
+    last_sampleR = last[1];
     lfo_phase_acc = phaseAcc;
-    transmit(blockL, 0);
-    transmit(blockR, 1);
-	release(blockL);
-    release(blockR);
-    if (blockMod) release((audio_block_t *)blockMod);
-#endif
-
-
 }
 
-
 bool AudioEffectPhaserStereo_i16::bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state)
 {
 	bool result = false;
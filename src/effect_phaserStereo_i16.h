@@ -204,8 +204,8 @@ private:
     uint8_t stg;                                    // number of stages
     bool bp;                                       // bypass
     audio_block_t *inputQueueArray[3];      
-    float32_t allpass_x[2][PHASER_STEREO_STAGES];      // allpass inputs
-	float32_t allpass_y[2][PHASER_STEREO_STAGES];      // allpass outputs
+	float32_t allpass_y[PHASER_STEREO_STAGES][2];      // allpass outputs, interleaved L/R pairs
+	float32_t allpass_in[2];                        // last allpass cascade input L/R
 	float32_t mix_ratio;                            // 0 = dry. 1.0 = wet
     float32_t feedb;                                // feedback 
 	static constexpr float32_t feedb_max = 0.95f;
@@ -220,6 +220,8 @@ private:
 	float32_t lfo_top;
 	float32_t lfo_btm;
 
+	template <int N>
+	void processStages(audio_block_t *blockL, audio_block_t *blockR, const audio_block_t *blockMod);
 	bool bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state);
 };
 
@@ -41,6 +41,14 @@
 
 #define RV_MASTER_LOWPASS_F (0.6f)                           // master lowpass scaled frequency coeff. 
 
+extern uint8_t external_psram_size;
+
+#if PLATEREVERB_I16_MODULATION
+	#define LP_DLY_TRIM		(0)
+#else
+	#define LP_DLY_TRIM		(sr_scale_len(20))		// unmodulated tank delays, the default chorus (LFO_AMPL = 20) is centred 20 samples below the buffer length
+#endif
+
 bool AudioEffectPlateReverb_i16::begin()
 {
 	inputGainSet = 0.5f;
@@ -68,17 +76,33 @@ bool AudioEffectPlateReverb_i16::begin()
 	in_allp_out_L = 0.0f;
     in_allp_out_R = 0.0f;
 
+	// failsafe if psram is required but not found, limit the room size to the default plate
+	#if ARDUINO_TEENSY41
+	if (psram_mode && external_psram_size == 0)
+	{
+		psram_mode = false;
+		if (room_max > 1.0f) room_max = 1.0f;
+	}
+	#else
+	psram_mode = false;
+	if (room_max > 1.0f) room_max = 1.0f;
+	#endif
+	// tank buffers are allocated for the largest room size
 	if(!lp_allp_1.init(&loop_allp_k)) return false;
-	if(!lp_allp_2.init(&loop_allp_k)) return false;
-	if(!lp_allp_3.init(&loop_allp_k)) return false;
-	if(!lp_allp_4.init(&loop_allp_k)) return false;
+	if(!lp_allp_2.init(roomScale(LP_ALLP2_BUF_LEN, room_max), &loop_allp_k, psram_mode)) return false;
+	if(!lp_allp_3.init(roomScale(LP_ALLP3_BUF_LEN, room_max), &loop_allp_k, psram_mode)) return false;
+	if(!lp_allp_4.init(roomScale(LP_ALLP4_BUF_LEN, room_max), &loop_allp_k, psram_mode)) return false;
 
     lp_allp_out = 0.0f;
 
-	if(!lp_dly1.init(LP_DLY1_BUF_LEN)) return false;
-	if(!lp_dly2.init(LP_DLY2_BUF_LEN)) return false;
-	if(!lp_dly3.init(LP_DLY3_BUF_LEN)) return false;
-	if(!lp_dly4.init(LP_DLY4_BUF_LEN)) return false;
+	if(!lp_dly1.init(roomScale(LP_DLY1_BUF_LEN - LP_DLY_TRIM, room_max), psram_mode)) return false;
+	if(!lp_dly2.init(roomScale(LP_DLY2_BUF_LEN - LP_DLY_TRIM, room_max), psram_mode)) return false;
+	if(!lp_dly3.init(roomScale(LP_DLY3_BUF_LEN - LP_DLY_TRIM, room_max), psram_mode)) return false;
+	if(!lp_dly4.init(roomScale(LP_DLY4_BUF_LEN - LP_DLY_TRIM, room_max), psram_mode)) return false;
+
+	room_size = room_size_cur = min(1.0f, room_max);
+	roomLengths(room_size_cur);
+	room_xf = false;
 
     lp_hidamp_k = 1.0f;
     lp_lodamp_k = 0.0f;
@@ -89,19 +113,22 @@ bool AudioEffectPlateReverb_i16::begin()
 
 	master_lp_k = 1.0f;
 	master_hp_k = 0.0f;
-	flt_masterL.init(0.08f, &master_hp_k, 0.1f, &master_lp_k);
-	flt_masterR.init(0.08f, &master_hp_k, 0.1f, &master_lp_k);
-
+#if PLATEREVERB_I16_MASTER_FILTER
+	master_lp_flt = 1.0f;
+	master_hp_flt = 0.0f;
+	flt_masterL.init(0.08f, &master_hp_flt, 0.1f, &master_lp_flt);
+	flt_masterR.init(0.08f, &master_hp_flt, 0.1f, &master_lp_flt);
+#endif
+
+#if PLATEREVERB_I16_PITCH
 	if(!pitchL.init()) return false;
-	if(!pitchR.init()) return false;
 	pitchL.setPitch(1.0f); //natural pitch
-	pitchR.setPitch(1.0f); //natural pitch
 	pitchL.setTone(0.36f);
-    pitchR.setTone(0.36f);
 	pitchL.setMix(0.0f);
-	pitchR.setMix(0.0f);
+#endif
 
 	shimmerRatio = 0.0f;
+#if PLATEREVERB_I16_SHIMMER
 	if(!pitchShimL.init()) return false;
 	if(!pitchShimR.init()) return false;
 	pitchShimL.setPitch(2.0f);
@@ -110,9 +137,22 @@ bool AudioEffectPlateReverb_i16::begin()
 	pitchShimR.setTone(0.26f);
 	pitchShimL.setMix(0.0f);
 	pitchShimR.setMix(0.0f);
+#endif
 
+	idle.init((uint32_t)(IDLE_HOLD_BLOCKS * room_max) + 1);
 	flags.bypass = 1;
     flags.freeze = 0;
+	flags.cleanup_done = 1;		// buffers are zeroed in init
+	flags.cleanup_busy = 0;
+	flags.autoIdle = 0;
+	flags.mono_force = 0;
+	flags.mono_in = 0;
+	flags.eco_in = 0;
+	flags.eco_flt = 0;
+	eco_warmup = 0;
+#if PLATEREVERB_I16_MODULATION
+	mod_gain = 1.0f;
+#endif
 	return true;
 }
 
@@ -125,38 +165,59 @@ void AudioEffectPlateReverb_i16::update()
 	int16_t i;
 	float acc;
     float rv_time;
+	bool bp;
+#if PLATEREVERB_I16_MODULATION
 	uint32_t offset;
 	float lfo_fr;
+#endif
+	float32_t in_allp_blkL[AUDIO_BLOCK_SAMPLES];
+	float32_t in_allp_blkR[AUDIO_BLOCK_SAMPLES];
+	float32_t in_eco_blk[AUDIO_BLOCK_SAMPLES];
+	float32_t wet_peak = 0.0f;		// tank output level for the auto idle
+	bool mono, eco, eco_xf, eco_wu;
+	int16_t in_diff, in_nonzero;
+#if PLATEREVERB_I16_MASTER_FILTER
+	bool master_flt;
+#endif
+#if PLATEREVERB_I16_MODULATION
+	float32_t mod_gain_step;
+	bool mod_on;
+#endif
 
 	blockL = receiveWritable(0);
 	blockR = receiveWritable(1);
-	if (!bypass_process(&blockL, &blockR, bp_mode, (bool)flags.bypass))
+	bp = flags.bypass || flags.cleanup_busy;	// stay bypassed until the cleanup is finished
+	// auto idle: silent input and decayed tail, skip the processing, no blocks transmitted
+	// input blocks in TRAILS bypass mode are discarded, treat them as silence
+	if (flags.autoIdle && (!bp || bp_mode == BYPASS_MODE_TRAILS))
+	{
+		if (idle.skip(bp ? NULL : blockL, bp ? NULL : blockR))
+		{
+			if (blockL) release(blockL);
+			if (blockR) release(blockR);
+#if PLATEREVERB_I16_MODULATION
+			// keep the modulation running, resume in phase
+			lfo1.update(AUDIO_BLOCK_SAMPLES);
+			lfo2.update(AUDIO_BLOCK_SAMPLES);
+#endif
+			return;
+		}
+	}
+	if (!bypass_process(&blockL, &blockR, bp_mode, bp))
 		return;
 
-    // handle bypass, 1st call will clean the buffers to avoid continuing the previous reverb tail
-    if (flags.bypass)
+    // handle bypass, the buffers are cleared over the next few blocks to avoid continuing the previous reverb tail
+    if (bp)
     {
 		if (!flags.cleanup_done && bp_mode != BYPASS_MODE_TRAILS)
 		{
-			in_allp_1L.reset();
-			in_allp_2L.reset();
-			in_allp_3L.reset();
-			in_allp_4L.reset();
-			in_allp_1R.reset();
-			in_allp_2R.reset();
-			in_allp_3R.reset();
-			in_allp_4R.reset();
-			lp_allp_1.reset();
-			lp_allp_2.reset();
-			lp_allp_3.reset();
-			lp_allp_4.reset();
-			lp_dly1.reset();
-			lp_dly2.reset();
-			lp_dly3.reset();
-			lp_dly4.reset();
+			memCleanupIdx = 0;
+			memCleanupStart = 0;
+			flags.cleanup_busy = 1;
 			flags.cleanup_done = 1;
 		}
-		if (bp_mode != BYPASS_MODE_TRAILS)
+		if (flags.cleanup_busy) flags.cleanup_busy = !memCleanup();
+		if (bp_mode != BYPASS_MODE_TRAILS || flags.cleanup_busy)
 		{
 			transmit(blockL, 0);
 			transmit(blockR, 1);
@@ -169,110 +230,273 @@ void AudioEffectPlateReverb_i16::update()
 	flags.cleanup_done = 0;
     rv_time = rv_time_k;
 
+	// mono input detection, a few identical blocks in a row switch to the mono path
+	// silent blocks keep the current state
+	in_diff = 0;
+	in_nonzero = 0;
+	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+	{
+		in_diff |= blockL->data[i] ^ blockR->data[i];
+		in_nonzero |= blockL->data[i];
+	}
+	if (in_diff) mono_cnt = 0;
+	else if (in_nonzero && mono_cnt < MONO_DETECT_BLOCKS) mono_cnt++;
+	mono = flags.mono_force || mono_cnt >= MONO_DETECT_BLOCKS;
+
+	// feed forward input stage, processed for the whole block: input gain, diffusers and pitch shifter
+	// eco mode uses only the first 2 diffusers per channel, changes are crossfaded over one block
+	eco = quality_mode == PLATE_QUALITY_ECO;
+	eco_xf = false;
+	eco_wu = false;
+	if (eco)
+	{
+		eco_xf = !flags.eco_in;
+		eco_warmup = 0;
+	}
+	else if (flags.eco_in)
+	{
+		if (!eco_warmup)
+		{
+			// 2nd half of the diffusers was not running in eco mode, clear the outdated contents
+			// and let them fill up before fading in, otherwise the first echoes would click
+			in_allp_3L.reset();
+			in_allp_4L.reset();
+			in_allp_3R.reset();
+			in_allp_4R.reset();
+			eco_warmup = ECO_WARMUP_BLOCKS;
+		}
+		if (--eco_warmup) eco_wu = true;
+		else eco_xf = true;
+	}
+	flags.eco_in = eco || eco_wu;
+	if (mono && flags.mono_in)
+	{
+		// mono input: convert and diffuse once, use it for both injection points
+		for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+		{
+			inputGain += (inputGainSet - inputGain) * 0.25f;
+			in_allp_blkL[i] = (float32_t)blockL->data[i] / 32768.0f * inputGain;
+		}
+	}
+	else
+	{
+		// R chain was not running in mono mode, clear the outdated contents
+		if (!mono && flags.mono_in)
+		{
+			in_allp_1R.reset();
+			in_allp_2R.reset();
+			in_allp_3R.reset();
+			in_allp_4R.reset();
+		}
+		for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+		{
+			inputGain += (inputGainSet - inputGain) * 0.25f;
+			in_allp_blkL[i] = (float32_t)blockL->data[i] / 32768.0f * inputGain;
+			in_allp_blkR[i] = (float32_t)blockR->data[i] / 32768.0f * inputGain;
+		}
+	}
+	// chained input allpasses, channel L
+	in_allp_1L.processBlock(in_allp_blkL, in_allp_blkL, AUDIO_BLOCK_SAMPLES);
+	in_allp_2L.processBlock(in_allp_blkL, in_allp_blkL, AUDIO_BLOCK_SAMPLES);
+	if (eco_wu)
+	{
+		memcpy(in_eco_blk, in_allp_blkL, AUDIO_BLOCK_SAMPLES*sizeof(float32_t));
+		in_allp_3L.processBlock(in_eco_blk, in_eco_blk, AUDIO_BLOCK_SAMPLES);
+		in_allp_4L.processBlock(in_eco_blk, in_eco_blk, AUDIO_BLOCK_SAMPLES);
+	}
+	else if (!eco || eco_xf)
+	{
+		if (eco_xf) memcpy(in_eco_blk, in_allp_blkL, AUDIO_BLOCK_SAMPLES*sizeof(float32_t));
+		in_allp_3L.processBlock(in_allp_blkL, in_allp_blkL, AUDIO_BLOCK_SAMPLES);
+		in_allp_4L.processBlock(in_allp_blkL, in_allp_blkL, AUDIO_BLOCK_SAMPLES);
+		if (eco_xf) xfade_f32(in_allp_blkL, in_eco_blk, AUDIO_BLOCK_SAMPLES, eco);
+	}
+	if (mono && flags.mono_in)
+	{
+		memcpy(in_allp_blkR, in_allp_blkL, AUDIO_BLOCK_SAMPLES*sizeof(float32_t));
+	}
+	else
+	{
+		// chained input allpasses, channel R
+		in_allp_1R.processBlock(in_allp_blkR, in_allp_blkR, AUDIO_BLOCK_SAMPLES);
+		in_allp_2R.processBlock(in_allp_blkR, in_allp_blkR, AUDIO_BLOCK_SAMPLES);
+		if (eco_wu)
+		{
+			memcpy(in_eco_blk, in_allp_blkR, AUDIO_BLOCK_SAMPLES*sizeof(float32_t));
+			in_allp_3R.processBlock(in_eco_blk, in_eco_blk, AUDIO_BLOCK_SAMPLES);
+			in_allp_4R.processBlock(in_eco_blk, in_eco_blk, AUDIO_BLOCK_SAMPLES);
+		}
+		else if (!eco || eco_xf)
+		{
+			if (eco_xf) memcpy(in_eco_blk, in_allp_blkR, AUDIO_BLOCK_SAMPLES*sizeof(float32_t));
+			in_allp_3R.processBlock(in_allp_blkR, in_allp_blkR, AUDIO_BLOCK_SAMPLES);
+			in_allp_4R.processBlock(in_allp_blkR, in_allp_blkR, AUDIO_BLOCK_SAMPLES);
+			if (eco_xf) xfade_f32(in_allp_blkR, in_eco_blk, AUDIO_BLOCK_SAMPLES, eco);
+		}
+		// mono/stereo transition, crossfade the R injection point over one block
+		if (mono != flags.mono_in)
+		{
+			xfade_f32(in_allp_blkR, in_allp_blkL, AUDIO_BLOCK_SAMPLES, mono);
+			flags.mono_in = mono;
+		}
+	}
+#if PLATEREVERB_I16_PITCH
+	pitchL.processBlock(in_allp_blkL, in_allp_blkL, AUDIO_BLOCK_SAMPLES);
+#endif
+
+#if PLATEREVERB_I16_SHIMMER
+	// shimmer pitch shifters are inside the tank, only the read positions and crossfade envelopes are precomputed
+	pitchShimL.prepareBlock(AUDIO_BLOCK_SAMPLES);
+	pitchShimR.prepareBlock(AUDIO_BLOCK_SAMPLES);
+#endif
+
+#if PLATEREVERB_I16_MASTER_FILTER
+	// eco mode: master filter fades to neutral settings within one block, then it's turned off
+	master_lp_flt = eco ? 1.0f : master_lp_k;
+	master_hp_flt = eco ? 0.0f : master_hp_k;
+	if (!eco && flags.eco_flt)
+	{
+		flt_masterL.reset();
+		flt_masterR.reset();
+	}
+	master_flt = !(eco && flags.eco_flt);
+	flags.eco_flt = eco;
+#endif
+#if PLATEREVERB_I16_MODULATION
+	mod_hi = quality_mode == PLATE_QUALITY_HI;
+	// 4 point interpolation reads up to 2 samples past the offset, keep them in the unmodulated part of the buffer
+	mod_hi_max = LFO_AMPL > 1 ? LFO_AMPL*2 - 2 : 0;
+	// eco mode fades the modulation out, once it's zero the delay lines are not touched
+	mod_gain_step = eco ? -MOD_GAIN_STEP : MOD_GAIN_STEP;
+	mod_on = LFO_AMPL && (!eco || mod_gain > 0.0f);
+#endif
+
+	// room size change, the tank read positions are crossfaded over one block
+	room_xf = false;
+	if (room_size != room_size_cur)
+	{
+		memcpy(lp_allp_len_old, lp_allp_len, sizeof(lp_allp_len));
+		memcpy(lp_dly_len_old, lp_dly_len, sizeof(lp_dly_len));
+		memcpy(lp_tap_old, lp_tap, sizeof(lp_tap));
+		room_size_cur = room_size;
+		roomLengths(room_size_cur);
+		room_xf = true;
+	}
+
+	// reverb tank, per sample processing
 	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
     {
+#if PLATEREVERB_I16_MODULATION
         // do the LFOs
 		lfo1.update();
 		lfo2.update();
-
-		inputGain += (inputGainSet - inputGain) * 0.25f;
+#endif
+		if (room_xf) room_xf_k = (float32_t)(i + 1) * (1.0f / AUDIO_BLOCK_SAMPLES);
 
 		sampleL = (float32_t)blockL->data[i] / 32768.0f;
-		acc = sampleL * inputGain;
-
-        // chained input allpasses, channel L
-		acc = in_allp_1L.process(acc);
-		acc = in_allp_2L.process(acc);
-		acc = in_allp_3L.process(acc);
-		in_allp_out_L = in_allp_4L.process(acc);
-		in_allp_out_L = pitchL.process(in_allp_out_L); 
-
-		// chained input allpasses, channel R
 		sampleR = (float32_t)blockR->data[i] / 32768.0f;
-        acc = sampleR * inputGain;
-
-		acc = in_allp_1R.process(acc);
-		acc = in_allp_2R.process(acc);
-		acc = in_allp_3R.process(acc);
-		in_allp_out_R = in_allp_4R.process(acc);
+		in_allp_out_L = in_allp_blkL[i];
+		in_allp_out_R = in_allp_blkR[i];
 
-		acc = pitchShimR.process(lp_allp_out + in_allp_out_R); // shimmer
+#if PLATEREVERB_I16_SHIMMER
+		acc = pitchShimR.processPrepared(lp_allp_out + in_allp_out_R, i); // shimmer
+#else
+		acc = lp_allp_out + in_allp_out_R;
+#endif
 
-	   	acc = lp_dly1.process(acc);
+	   	acc = lp_dly_process(lp_dly1, acc, 0);
 		acc = flt1.process(acc) * rv_time * rv_time_scaler;
 
-		acc = lp_allp_2.process(acc + in_allp_out_L);
-		acc = lp_dly2.process(acc);
+		acc = lp_allp_process(lp_allp_2, acc + in_allp_out_L, 0);
+		acc = lp_dly_process(lp_dly2, acc, 1);
 		acc = flt2.process(acc) * rv_time * rv_time_scaler;
 
-		acc = pitchShimL.process(acc + in_allp_out_R); // shimmer
-
-		acc = lp_allp_3.process(acc);
-	   	acc = lp_dly3.process(acc);
+#if PLATEREVERB_I16_SHIMMER
+		acc = pitchShimL.processPrepared(acc + in_allp_out_R, i); // shimmer
+		acc = lp_allp_process(lp_allp_3, acc, 1);
+#else
+		acc = lp_allp_process(lp_allp_3, acc + in_allp_out_R, 1);
+#endif
+	   	acc = lp_dly_process(lp_dly3, acc, 2);
 		acc = flt3.process(acc) * rv_time * rv_time_scaler;
 
-		acc = lp_allp_4.process(acc + in_allp_out_L);
-		acc = lp_dly4.process(acc);
+		acc = lp_allp_process(lp_allp_4, acc + in_allp_out_L, 2);
+		acc = lp_dly_process(lp_dly4, acc, 3);
 		
 		lp_allp_out = flt4.process(acc) * rv_time * rv_time_scaler; 
 
-		acc  = lp_dly1.getTap(lp_dly1_offset_L) * 0.8f;
-		acc += lp_dly2.getTap(lp_dly2_offset_L) * 0.7f;
-		acc += lp_dly3.getTap(lp_dly3_offset_L) * 0.6f;
-		acc += lp_dly4.getTap(lp_dly4_offset_L) * 0.5f;
+		acc  = lp_tap_get(lp_dly1, 0) * 0.8f;
+		acc += lp_tap_get(lp_dly2, 1) * 0.7f;
+		acc += lp_tap_get(lp_dly3, 2) * 0.6f;
+		acc += lp_tap_get(lp_dly4, 3) * 0.5f;
 
+#if PLATEREVERB_I16_MASTER_FILTER
         // Master lowpass filter
-		acc = flt_masterL.process(acc);
-
+		if (master_flt) acc = flt_masterL.process(acc);
+#endif
+		wet_peak = fmaxf(wet_peak, fabsf(acc));
 		sampleL = acc * wet_gain + sampleL * dry_gain; 
 		if (sampleL > 1.0f) 		sampleL = 1.0f;
 		else if (sampleL < -1.0f) 	sampleL = -1.0f;
 		blockL->data[i] = (int16_t)(sampleL * 32767.0f); 
         // ChannelR
-		acc  = lp_dly1.getTap(lp_dly1_offset_R) * 0.8f;
-		acc += lp_dly2.getTap(lp_dly2_offset_R) * 0.7f;
-		acc += lp_dly3.getTap(lp_dly3_offset_R) * 0.6f;
-		acc += lp_dly4.getTap(lp_dly4_offset_R) * 0.5f;
+		acc  = lp_tap_get(lp_dly1, 4) * 0.8f;
+		acc += lp_tap_get(lp_dly2, 5) * 0.7f;
+		acc += lp_tap_get(lp_dly3, 6) * 0.6f;
+		acc += lp_tap_get(lp_dly4, 7) * 0.5f;
+#if PLATEREVERB_I16_MASTER_FILTER
         // Master lowpass filter
-		acc = flt_masterR.process(acc);
-
+		if (master_flt) acc = flt_masterR.process(acc);
+#endif
+		wet_peak = fmaxf(wet_peak, fabsf(acc));
 		sampleR =  acc * wet_gain + sampleR * dry_gain;
 		if (sampleR > 1.0f)		sampleR = 1.0f;
 		else if (sampleR < -1.0f) 	sampleR = -1.0f;
 
 		blockR->data[i] = (int16_t)(sampleR * 32767.0f);
 
+#if PLATEREVERB_I16_MODULATION
 		// modulate the delay lines
-		// delay 1
-		lfo1.get(BASIC_LFO_PHASE_0, &offset, &lfo_fr); 				// lfo1 sin output
-		acc = lp_dly1.getTap(offset, lfo_fr);
-		lp_dly1.write_toOffset(acc, LFO_AMPL*2);
+		if (mod_on)
+		{
+			mod_gain += mod_gain_step;
+			if (mod_gain > 1.0f) mod_gain = 1.0f;
+			else if (mod_gain < 0.0f) mod_gain = 0.0f;
+			// delay 1
+			lfo1.get(BASIC_LFO_PHASE_0, &offset, &lfo_fr); 				// lfo1 sin output
+			acc = mod_tap(lp_dly1, offset, lfo_fr);
+			lp_dly1.write_toOffset(acc, LFO_AMPL*2);
+
+			// delay 2
+			lfo1.get(BASIC_LFO_PHASE_90, &offset, &lfo_fr); 			// lfo1 cos output
+			acc = mod_tap(lp_dly2, offset, lfo_fr);
+			lp_dly2.write_toOffset(acc, LFO_AMPL*2);
+
+			// delay 3
+			lfo2.get(BASIC_LFO_PHASE_0, &offset, &lfo_fr); 				// lfo2 sin output
+			acc = mod_tap(lp_dly3, offset, lfo_fr);
+			lp_dly3.write_toOffset(acc, LFO_AMPL*2);
+	
+			// delay 4
+			lfo2.get(BASIC_LFO_PHASE_90, &offset, &lfo_fr); 			// lfo2 cos output
+			acc = mod_tap(lp_dly4, offset, lfo_fr);
+			lp_dly4.write_toOffset(acc, LFO_AMPL*2);
+		}
+#endif
 		lp_dly1.updateIndex();
-
-		// delay 2
-		lfo1.get(BASIC_LFO_PHASE_90, &offset, &lfo_fr); 			// lfo1 cos output
-		acc = lp_dly2.getTap(offset, lfo_fr);
-		lp_dly2.write_toOffset(acc, LFO_AMPL*2);
 		lp_dly2.updateIndex();
-
-		// delay 3
-		lfo2.get(BASIC_LFO_PHASE_0, &offset, &lfo_fr); 				// lfo2 sin output
-		acc = lp_dly3.getTap(offset, lfo_fr);
-		lp_dly3.write_toOffset(acc, LFO_AMPL*2);
 		lp_dly3.updateIndex();
- 
-		// delay 4
-		lfo2.get(BASIC_LFO_PHASE_90, &offset, &lfo_fr); 			// lfo2 cos output
-		acc = lp_dly4.getTap(offset, lfo_fr);
-		lp_dly4.write_toOffset(acc, LFO_AMPL*2);
-		lp_dly4.updateIndex();		
+		lp_dly4.updateIndex();
 	}
+#if PLATEREVERB_I16_MODULATION
 	if (LFO_AMPL != LFO_AMPLset) 
 	{
+		LFO_AMPL = LFO_AMPLset;
 		lfo1.setDepth(LFO_AMPL);
 		lfo2.setDepth(LFO_AMPL);
-		LFO_AMPL = LFO_AMPLset;
 	}
+#endif
+	if (flags.autoIdle) idle.update(wet_peak);
     transmit(blockL, 0);
 	transmit(blockR, 1);
 	release(blockL);
@@ -280,6 +504,100 @@ void AudioEffectPlateReverb_i16::update()
 	#endif
 }
 
+/**
+ * @brief calculate the tank lengths and output tap positions for the given room size
+ * 
+ * @param scale room size, 1.0f = default plate
+ */
+void AudioEffectPlateReverb_i16::roomLengths(float32_t scale)
+{
+	lp_allp_len[0] = roomScale(LP_ALLP2_BUF_LEN, scale);
+	lp_allp_len[1] = roomScale(LP_ALLP3_BUF_LEN, scale);
+	lp_allp_len[2] = roomScale(LP_ALLP4_BUF_LEN, scale);
+
+	lp_dly_len[0] = roomScale(LP_DLY1_BUF_LEN - LP_DLY_TRIM, scale);
+	lp_dly_len[1] = roomScale(LP_DLY2_BUF_LEN - LP_DLY_TRIM, scale);
+	lp_dly_len[2] = roomScale(LP_DLY3_BUF_LEN - LP_DLY_TRIM, scale);
+	lp_dly_len[3] = roomScale(LP_DLY4_BUF_LEN - LP_DLY_TRIM, scale);
+
+	lp_tap[0] = roomScale(lp_dly1_offset_L, scale);
+	lp_tap[1] = roomScale(lp_dly2_offset_L, scale);
+	lp_tap[2] = roomScale(lp_dly3_offset_L, scale);
+	lp_tap[3] = roomScale(lp_dly4_offset_L, scale);
+	lp_tap[4] = roomScale(lp_dly1_offset_R, scale);
+	lp_tap[5] = roomScale(lp_dly2_offset_R, scale);
+	lp_tap[6] = roomScale(lp_dly3_offset_R, scale);
+	lp_tap[7] = roomScale(lp_dly4_offset_R, scale);
+}
+
+/**
+ * @brief Partial buffer clear
+ * 	Clearing all the reverb buffers at once takes too long 
+ * 	for the audio ISR. One allpass group or a portion of
+ *  a delay line is cleared per audio update.
+ * 
+ * @return true 	Memory clean is complete
+ * @return false 	Memory clean still in progress
+ */
+bool AudioEffectPlateReverb_i16::memCleanup()
+{
+	bool result = false;
+	switch(memCleanupIdx)
+	{
+		case 0:
+			in_allp_1L.reset();
+			in_allp_2L.reset();
+			in_allp_3L.reset();
+			in_allp_4L.reset();
+			memCleanupIdx++;
+			break;
+		case 1:
+			in_allp_1R.reset();
+			in_allp_2R.reset();
+			in_allp_3R.reset();
+			in_allp_4R.reset();
+			memCleanupIdx++;
+			break;
+		case 2:		lp_allp_1.reset();	memCleanupIdx++;	break;
+		case 3:		if (memCleanupDelay(lp_allp_2)) memCleanupIdx++;	break;
+		case 4:		if (memCleanupDelay(lp_allp_3)) memCleanupIdx++;	break;
+		case 5:		if (memCleanupDelay(lp_allp_4)) memCleanupIdx++;	break;
+		case 6:		if (memCleanupDelay(lp_dly1)) memCleanupIdx++;	break;
+		case 7:		if (memCleanupDelay(lp_dly2)) memCleanupIdx++;	break;
+		case 8:		if (memCleanupDelay(lp_dly3)) memCleanupIdx++;	break;
+		case 9:		
+			if (memCleanupDelay(lp_dly4)) 
+			{
+				memCleanupIdx = 0;
+				result = true;
+			}
+			break;
+		default:
+			memCleanupIdx = 0;
+			break;
+	}
+	return result;
+}
+
+/**
+ * @brief clear one portion of the delay line or tank allpass
+ * 
+ * @param dly delay line
+ * @return true if the whole delay line is cleared
+ */
+template <class T> 
+bool AudioEffectPlateReverb_i16::memCleanupDelay(T &dly)
+{
+	dly.reset(memCleanupStart, memCleanupStart + memCleanupStep);
+	memCleanupStart += memCleanupStep;
+	if (memCleanupStart >= dly.size_get())
+	{
+		memCleanupStart = 0;
+		return true;
+	}
+	return false;
+}
+
 bool AudioEffectPlateReverb_i16::bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state)
 {
 	bool result = false;
@@ -39,11 +39,48 @@
 #include "arm_math.h"
 #include "basic_components.h"
 
+// Build time feature selection, set to 0 (ie. in the build flags) to strip the unused 
+// processing stages and their memory from the reverb
+#ifndef PLATEREVERB_I16_SHIMMER
+	#define PLATEREVERB_I16_SHIMMER			1	// pitch shifters in the reverb tank
+#endif
+#ifndef PLATEREVERB_I16_PITCH
+	#define PLATEREVERB_I16_PITCH			1	// reverb pitch shifter
+#endif
+#ifndef PLATEREVERB_I16_MODULATION
+	#define PLATEREVERB_I16_MODULATION		1	// tank delay lines modulation (chorus)
+#endif
+#ifndef PLATEREVERB_I16_MASTER_FILTER
+	#define PLATEREVERB_I16_MASTER_FILTER	1	// output lowpass/highpass filters
+#endif
+#ifndef PLATEREVERB_I16_ROOM_MIN
+	#define PLATEREVERB_I16_ROOM_MIN		(0.25f)	// smallest tank size relative to the default plate
+#endif
+
+// runtime quality/CPU load setting
+typedef enum
+{
+	PLATE_QUALITY_ECO,		// 2 input diffusers per channel, no tank modulation, no master filter
+	PLATE_QUALITY_NORMAL,	// default
+	PLATE_QUALITY_HI		// hermite interpolated tank modulation
+}plate_quality_t;
 
 class AudioEffectPlateReverb_i16 :  public AudioStream
 {
 public:
-    AudioEffectPlateReverb_i16() : AudioStream(2, inputQueueArray) { initialized = begin();}
+	/**
+	 * @brief Construct a new plate reverb
+	 * 
+	 * @param roomMax 	largest room size (tank length scaler), the tank memory is allocated for it, 
+	 * 					1.0f = default plate
+	 * @param use_psram place the tank buffers in PSRAM, Teensy4.1 only
+	 */
+    AudioEffectPlateReverb_i16(float32_t roomMax = 1.0f, bool use_psram = false) : AudioStream(2, inputQueueArray) 
+	{
+		room_max = max(roomMax, PLATEREVERB_I16_ROOM_MIN);
+		psram_mode = use_psram;
+		initialized = begin();
+	}
 	~AudioEffectPlateReverb_i16(){};
     virtual void update();
 
@@ -78,6 +115,23 @@ public:
 	 */
 	float size_get(void) {return rv_time_k;}
 
+	/**
+	 * @brief scales the length of the reverb tank, small plates to large halls.
+	 * 		New lengths are applied by crossfading the tank read positions over one block,
+	 * 		the memory is not reallocated.
+	 * 
+	 * @param n PLATEREVERB_I16_ROOM_MIN to the roomMax set in the constructor, 1.0f = default plate
+	 */
+	void roomSize(float n)
+	{
+		n = constrain(n, PLATEREVERB_I16_ROOM_MIN, room_max);
+		__disable_irq();
+		room_size = n;
+		__enable_irq();
+	}
+	float roomSize_get(void) {return room_size;}
+	float roomSize_getMax(void) {return room_max;}
+
 	/**
 	 * @brief Treble loss in reverb tail
 	 * 
@@ -166,8 +220,10 @@ public:
             rv_time_scaler = 1.0f;
             lp_lodamp_k = freeze_lodamp_k;
             lp_hidamp_k = freeze_hidamp_k;
+#if PLATEREVERB_I16_SHIMMER
 			pitchShimL.setMix(0.0f);	// shimmer off
 			pitchShimR.setMix(0.0f);
+#endif
 			__enable_irq();
         }
         else
@@ -281,6 +337,68 @@ public:
 		bypass_set(flags.bypass^1);
         return flags.bypass;
     }
+	/**
+	 * @brief buffer cleanup after bypassing the reverb is spread over several audio blocks,
+	 * 		the reverb stays bypassed until it's finished
+	 * 
+	 * @return true if the cleanup is in progress
+	 */
+	bool cleanup_busy() {return flags.cleanup_busy;}
+	/**
+	 * @brief enables the automatic idle mode. If the input is silent and the reverb tail
+	 * 		has decayed below the threshold, the processing is skipped and no audio blocks
+	 * 		are transmitted. The first non silent input block resumes the processing.
+	 * 
+	 * @param state true = enabled
+	 */
+	void autoIdle_set(bool state)
+	{
+		__disable_irq();
+		flags.autoIdle = state;
+		idle.reset();
+		__enable_irq();
+	}
+	bool autoIdle_get() {return flags.autoIdle;}
+	/**
+	 * @brief sets the silence threshold used by the auto idle mode
+	 * 
+	 * @param thr max absolute sample value treated as silence
+	 */
+	void autoIdle_threshold(int16_t thr)
+	{
+		__disable_irq();
+		idle.threshold(thr);
+		__enable_irq();
+	}
+	bool idle_get() {return idle.get();}
+	/**
+	 * @brief input mono mode. Identical L and R input blocks are detected automatically,
+	 * 		in mono mode the input is diffused once and fed to both tank injection points.
+	 * 
+	 * @param state true = force mono, false = automatic detection
+	 */
+	void monoInput(bool state)
+	{
+		__disable_irq();
+		flags.mono_force = state;
+		__enable_irq();
+	}
+	bool monoInput_get() {return flags.mono_in;}
+	/**
+	 * @brief sets the processing quality, lower settings free up the CPU.
+	 * 		Switching is done without memory reallocation, changes are crossfaded
+	 * 		or ramped over a few audio blocks.
+	 * 
+	 * @param q PLATE_QUALITY_ECO, PLATE_QUALITY_NORMAL or PLATE_QUALITY_HI
+	 */
+	void quality(plate_quality_t q)
+	{
+		if (q > PLATE_QUALITY_HI) return;
+		__disable_irq();
+		quality_mode = q;
+		__enable_irq();
+	}
+	plate_quality_t quality_get() {return quality_mode;}
 
 	/**
 	 * @brief controls the delay line modulation, higher values create chorus effect
@@ -289,12 +407,13 @@ public:
 	 */
 	void chorus(float c)
 	{
-		c = map(c, 0.0f, 1.0f, 1.0f, 100.0f);
+		c = map(c, 0.0f, 1.0f, 1.0f, (float32_t)sr_scale_len(100));
 		__disable_irq();
 		LFO_AMPLset = (uint32_t)c; 
 		__enable_irq();
 	}
 
+#if PLATEREVERB_I16_SHIMMER
 	/**
 	 * @brief Contriols the amount of shimmer effect
 	 * 
@@ -352,6 +471,28 @@ public:
 		__enable_irq();
 	}
 	int8_t shimmerPitch_get() {return pitchShim_semit;}
+	/**
+	 * @brief Sets the shimmer pitch shifter interpolation method
+	 * 			drop sample (lowest CPU load) is usually good enough inside the reverb tank
+	 * 
+	 * @param mode PITCH_INTERP_DROP, PITCH_INTERP_LINEAR or PITCH_INTERP_HERMITE
+	 */
+	void shimmerInterpolation(pitch_interp_t mode)
+	{
+		__disable_irq();
+		pitchShimL.setInterpolation(mode);
+		pitchShimR.setInterpolation(mode);
+		__enable_irq();
+	}
+#else
+	void shimmer(float s) {}
+	void shimmerPitch(float ratio) {}
+	void shimmerPitchSemitones(int8_t semitones) {}
+	void shimmerPitchNormalized(float32_t value) {}
+	int8_t shimmerPitch_get() {return 0;}
+	void shimmerInterpolation(pitch_interp_t mode) {}
+#endif // PLATEREVERB_I16_SHIMMER
+#if PLATEREVERB_I16_PITCH
 	/**
 	 * @brief set the reverb pitch.  Range -12 to +24 
 	 * 
@@ -361,7 +502,6 @@ public:
 	{
 		__disable_irq();
 		pitchL.setPitchSemintone(semitones);
-		pitchR.setPitchSemintone(semitones);
 		__enable_irq();
 	}
 	/**
@@ -377,10 +517,20 @@ public:
 		pitch_semit = semitoneTable[(uint8_t)idx];
 		__disable_irq();
 		pitchL.setPitchSemintone(pitch_semit);
-		pitchR.setPitchSemintone(pitch_semit);
 		__enable_irq();
 	}
 	int8_t pitch_get() {return pitch_semit;}
+	/**
+	 * @brief Sets the reverb pitch shifter interpolation method
+	 * 
+	 * @param mode PITCH_INTERP_DROP, PITCH_INTERP_LINEAR or PITCH_INTERP_HERMITE
+	 */
+	void pitchInterpolation(pitch_interp_t mode)
+	{
+		__disable_irq();
+		pitchL.setInterpolation(mode);
+		__enable_irq();
+	}
 	/**
 	 * @brief Reverb pitch shifter dry/wet mixer
 	 * 
@@ -391,10 +541,16 @@ public:
 		s = constrain(s, 0.0f, 1.0f);
 		__disable_irq();
 		pitchL.setMix(s);
-		pitchR.setMix(s);
 		pitchRatio = s;
 		__enable_irq();
 	}
+#else
+	void pitchSemitones(int8_t semitones) {}
+	void pitchNormalized(float32_t value) {}
+	int8_t pitch_get() {return 0;}
+	void pitchInterpolation(pitch_interp_t mode) {}
+	void pitchMix(float s) {}
+#endif // PLATEREVERB_I16_PITCH
 	bool isInitialized() { return initialized;}
 private:
     struct flags_t
@@ -403,39 +559,56 @@ private:
         unsigned freeze:            1;
         unsigned shimmer:           1;
         unsigned cleanup_done:      1;
+        unsigned cleanup_busy:      1;
+        unsigned autoIdle:          1;
+        unsigned mono_force:        1;
+        unsigned mono_in:           1;
+        unsigned eco_in:            1;		// input diffusers reduced
+        unsigned eco_flt:           1;		// master filter off
     }flags;
+	plate_quality_t quality_mode = PLATE_QUALITY_NORMAL;
 	bypass_mode_t bp_mode = BYPASS_MODE_PASS;
     audio_block_t *inputQueueArray[2];
 
-	static const uint16_t IN_ALLP1_BUFL_LEN = 224u;
-	static const uint16_t IN_ALLP2_BUFL_LEN = 420u;
-	static const uint16_t IN_ALLP3_BUFL_LEN = 856u;
-	static const uint16_t IN_ALLP4_BUFL_LEN = 1089u;
-
-	static const uint16_t IN_ALLP1_BUFR_LEN = 156u;
-	static const uint16_t IN_ALLP2_BUFR_LEN = 520u;
-	static const uint16_t IN_ALLP3_BUFR_LEN = 956u;
-	static const uint16_t IN_ALLP4_BUFR_LEN = 1289u;
-
-	static const uint16_t LP_ALLP1_BUF_LEN  = 2303u;
-	static const uint16_t LP_ALLP2_BUF_LEN  = 2905u;
-	static const uint16_t LP_ALLP3_BUF_LEN  = 3175u;
-	static const uint16_t LP_ALLP4_BUF_LEN  = 2398u;
-
-	static const uint16_t LP_DLY1_BUF_LEN   = 3423u;
-	static const uint16_t LP_DLY2_BUF_LEN   = 4589u;
-	static const uint16_t LP_DLY3_BUF_LEN   = 4365u;
-	static const uint16_t LP_DLY4_BUF_LEN   = 3698u;
-
-    const uint16_t lp_dly1_offset_L = 201;
-    const uint16_t lp_dly2_offset_L = 145;
-    const uint16_t lp_dly3_offset_L = 1897;
-    const uint16_t lp_dly4_offset_L = 280;
-
-    const uint16_t lp_dly1_offset_R = 1897;
-    const uint16_t lp_dly2_offset_R = 1245;
-    const uint16_t lp_dly3_offset_R = 487;
-    const uint16_t lp_dly4_offset_R = 780;  
+	static const uint16_t IN_ALLP1_BUFL_LEN = sr_scale_len(224);
+	static const uint16_t IN_ALLP2_BUFL_LEN = sr_scale_len(420);
+	static const uint16_t IN_ALLP3_BUFL_LEN = sr_scale_len(856);
+	static const uint16_t IN_ALLP4_BUFL_LEN = sr_scale_len(1089);
+
+	static const uint16_t IN_ALLP1_BUFR_LEN = sr_scale_len(156);
+	static const uint16_t IN_ALLP2_BUFR_LEN = sr_scale_len(520);
+	static const uint16_t IN_ALLP3_BUFR_LEN = sr_scale_len(956);
+	static const uint16_t IN_ALLP4_BUFR_LEN = sr_scale_len(1289);
+
+	static const uint16_t LP_ALLP1_BUF_LEN  = sr_scale_len(2303);
+	static const uint16_t LP_ALLP2_BUF_LEN  = sr_scale_len(2905);
+	static const uint16_t LP_ALLP3_BUF_LEN  = sr_scale_len(3175);
+	static const uint16_t LP_ALLP4_BUF_LEN  = sr_scale_len(2398);
+
+	static const uint16_t LP_DLY1_BUF_LEN   = sr_scale_len(3423);
+	static const uint16_t LP_DLY2_BUF_LEN   = sr_scale_len(4589);
+	static const uint16_t LP_DLY3_BUF_LEN   = sr_scale_len(4365);
+	static const uint16_t LP_DLY4_BUF_LEN   = sr_scale_len(3698);
+	// the whole tank has to be flushed before going idle
+	static const uint32_t IDLE_HOLD_BLOCKS  = (LP_ALLP1_BUF_LEN + LP_ALLP2_BUF_LEN + LP_ALLP3_BUF_LEN + LP_ALLP4_BUF_LEN +
+											   LP_DLY1_BUF_LEN + LP_DLY2_BUF_LEN + LP_DLY3_BUF_LEN + LP_DLY4_BUF_LEN) / AUDIO_BLOCK_SAMPLES + 1;
+	AudioBasicIdle idle;
+	// number of identical L/R input blocks required to switch to the mono input path
+	static const uint8_t MONO_DETECT_BLOCKS = 32;
+	// leaving eco mode: diffusers 3 and 4 run for a few times their length before being faded in
+	static const uint32_t ECO_WARMUP_BLOCKS = 4 * (IN_ALLP3_BUFR_LEN + IN_ALLP4_BUFR_LEN) / AUDIO_BLOCK_SAMPLES + 1;
+	uint32_t eco_warmup = 0;
+	uint8_t mono_cnt = 0;
+
+    const uint16_t lp_dly1_offset_L = sr_scale_len(201);
+    const uint16_t lp_dly2_offset_L = sr_scale_len(145);
+    const uint16_t lp_dly3_offset_L = sr_scale_len(1897);
+    const uint16_t lp_dly4_offset_L = sr_scale_len(280);
+
+    const uint16_t lp_dly1_offset_R = sr_scale_len(1897);
+    const uint16_t lp_dly2_offset_R = sr_scale_len(1245);
+    const uint16_t lp_dly3_offset_R = sr_scale_len(487);
+    const uint16_t lp_dly4_offset_R = sr_scale_len(780);  
 
 	AudioFilterAllpass<IN_ALLP1_BUFL_LEN> in_allp_1L;
 	AudioFilterAllpass<IN_ALLP2_BUFL_LEN> in_allp_2L;
@@ -448,14 +621,42 @@ private:
 	AudioFilterAllpass<IN_ALLP4_BUFR_LEN> in_allp_4R;
 
 	AudioFilterAllpass<LP_ALLP1_BUF_LEN> lp_allp_1;
-	AudioFilterAllpass<LP_ALLP2_BUF_LEN> lp_allp_2;
-	AudioFilterAllpass<LP_ALLP3_BUF_LEN> lp_allp_3;
-	AudioFilterAllpass<LP_ALLP4_BUF_LEN> lp_allp_4;
+	AudioFilterAllpassVar lp_allp_2;
+	AudioFilterAllpassVar lp_allp_3;
+	AudioFilterAllpassVar lp_allp_4;
 
-	uint16_t LFO_AMPL = 20u;
-	uint16_t LFO_AMPLset = 20u;
+	uint16_t LFO_AMPL = sr_scale_len(20u);
+	uint16_t LFO_AMPLset = sr_scale_len(20u);
+#if PLATEREVERB_I16_MODULATION
 	AudioBasicLfo lfo1 = AudioBasicLfo(1.35f, LFO_AMPL);
 	AudioBasicLfo lfo2 = AudioBasicLfo(1.57f, LFO_AMPL);
+	static constexpr float32_t MOD_GAIN_STEP = 1.0f / (64 * AUDIO_BLOCK_SAMPLES);	// eco mode modulation fade, 64 blocks
+	float32_t mod_gain = 1.0f;			// modulation amount, faded out in eco mode
+	uint32_t mod_hi_max;
+	bool mod_hi;
+	inline float32_t mod_tap(AudioBasicDelay &dly, uint32_t offs, float32_t frac)
+	{
+		float32_t y;
+		if (mod_hi)
+		{
+			// clip the read position, not only its integer part, avoids a jump at the LFO peaks
+			if (offs >= mod_hi_max)
+			{
+				offs = mod_hi_max;
+				frac = 0.0f;
+			}
+			y = dly.getTapHermite(offs, frac);
+		}
+		else y = dly.getTap(offs, frac);
+		if (mod_gain < 1.0f)
+		{
+			// blend with the unmodulated sample, writing it back does not change the buffer
+			float32_t y0 = dly.getTap(LFO_AMPL*2);
+			y = y0 + (y - y0) * mod_gain;
+		}
+		return y;
+	}
+#endif
 
     float inputGain;
 	float inputGainSet;
@@ -475,6 +676,34 @@ private:
 	AudioBasicDelay lp_dly3;
 	AudioBasicDelay lp_dly4;
 
+	// room size: tank allpass 2-4 and delay 1-4 lengths and the output taps are scaled
+	// within the buffers allocated for room_max
+	float32_t room_max;
+	float32_t room_size = 1.0f;
+	float32_t room_size_cur = 1.0f;
+	bool psram_mode;
+	uint32_t lp_allp_len[3], lp_allp_len_old[3];
+	uint32_t lp_dly_len[4], lp_dly_len_old[4];
+	uint32_t lp_tap[8], lp_tap_old[8];		// output taps, L: 0-3, R: 4-7
+	bool room_xf;							// length change crossfade in progress
+	float32_t room_xf_k;
+	void roomLengths(float32_t scale);
+	inline uint32_t roomScale(uint32_t len, float32_t scale) { return (uint32_t)((float32_t)len * scale + 0.5f); }
+	inline float32_t lp_allp_process(AudioFilterAllpassVar &allp, float32_t in, uint32_t n)
+	{
+		return room_xf ? allp.process(in, lp_allp_len_old[n], lp_allp_len[n], room_xf_k) : allp.process(in, lp_allp_len[n]);
+	}
+	inline float32_t lp_dly_process(AudioBasicDelay &dly, float32_t in, uint32_t n)
+	{
+		float32_t out = room_xf ? dly.getTapXf(lp_dly_len_old[n], lp_dly_len[n], room_xf_k) : dly.getTap(lp_dly_len[n]);
+		dly.write(in);
+		return out;
+	}
+	inline float32_t lp_tap_get(AudioBasicDelay &dly, uint32_t n)
+	{
+		return room_xf ? dly.getTapXf(lp_tap_old[n], lp_tap[n], room_xf_k) : dly.getTap(lp_tap[n]);
+	}
+
     float lp_hidamp_k, lp_hidamp_k_tmp;       // loop high band damping coeff
     float lp_lodamp_k, lp_lodamp_k_tmp;       // loop low band damping coeff
 
@@ -484,16 +713,22 @@ private:
 	AudioFilterShelvingLPHP flt4;
 
 	float master_lp_k, master_hp_k;
+	float master_lp_flt, master_hp_flt;	// filter coeffs, neutral in eco mode
+#if PLATEREVERB_I16_MASTER_FILTER
 	AudioFilterShelvingLPHP flt_masterL;
 	AudioFilterShelvingLPHP flt_masterR;
-	// Shimmer
+#endif
+	// Pitch, applied to the L input chain
 	float pitchRatio = 0.0f;
+#if PLATEREVERB_I16_PITCH
 	AudioBasicPitch	pitchL;
-	AudioBasicPitch	pitchR;
-
+#endif
+	// Shimmer
 	float shimmerRatio = 0.0f;
+#if PLATEREVERB_I16_SHIMMER
 	AudioBasicPitch	pitchShimL;
 	AudioBasicPitch	pitchShimR;
+#endif
 
 	const int8_t semitoneTable[9] = {-12, -7, -5, -3, 0, 3, 5, 7, 12};
 	int8_t pitch_semit;
@@ -510,6 +745,12 @@ private:
 	bool initialized = false;
 	uint16_t block_size = AUDIO_BLOCK_SAMPLES;
 
+	bool memCleanup(void);
+	template <class T> bool memCleanupDelay(T &dly);
+	const uint32_t memCleanupStep = 2048;
+	uint32_t memCleanupStart = 0;
+	uint8_t memCleanupIdx = 0;
+
 	bool bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state);
 };
 
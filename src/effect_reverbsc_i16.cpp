@@ -7,44 +7,60 @@
 	#define M_PI 3.14159265358979323846 /* pi */
 #endif
 
-/* kReverbParams[n][0] = delay time (in seconds)                     */
+/* kReverbParams[n][0] = delay time (in seconds), tuned at BASIC_SR_REF */
 /* kReverbParams[n][1] = random variation in delay time (in seconds) */
 /* kReverbParams[n][2] = random variation frequency (in 1/sec)       */
 /* kReverbParams[n][3] = random seed (0 - 32767)                     */
 
-static const float32_t kReverbParams[8][4] =
+static const float32_t kReverbParams[REVERBSC_I16_LINES_MAX][4] =
 {
-	{(2473.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0010f, 3.100f, 1966.0f},
-	{(2767.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0011f, 3.500f, 29491.0f},
-	{(3217.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0017f, 1.110f, 22937.0f},
-	{(3557.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0006f, 3.973f, 9830.0f},
-	{(3907.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0010f, 2.341f, 20643.0f},
-	{(4127.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0011f, 1.897f, 22937.0f},
-	{(2143.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0017f, 0.891f, 29491.0f},
-	{(1933.0f / AUDIO_SAMPLE_RATE_EXACT), 0.0006f, 3.221f, 14417.0f}
+	{(2473.0f / BASIC_SR_REF), 0.0010f, 3.100f, 1966.0f},
+	{(2767.0f / BASIC_SR_REF), 0.0011f, 3.500f, 29491.0f},
+	{(3217.0f / BASIC_SR_REF), 0.0017f, 1.110f, 22937.0f},
+	{(3557.0f / BASIC_SR_REF), 0.0006f, 3.973f, 9830.0f},
+	{(3907.0f / BASIC_SR_REF), 0.0010f, 2.341f, 20643.0f},
+	{(4127.0f / BASIC_SR_REF), 0.0011f, 1.897f, 22937.0f},
+	{(2143.0f / BASIC_SR_REF), 0.0017f, 0.891f, 29491.0f},
+	{(1933.0f / BASIC_SR_REF), 0.0006f, 3.221f, 14417.0f},
+	// 16 line network
+	{(1789.0f / BASIC_SR_REF), 0.0012f, 2.713f, 21222.0f},
+	{(1999.0f / BASIC_SR_REF), 0.0009f, 1.523f, 9886.0f},
+	{(2287.0f / BASIC_SR_REF), 0.0015f, 3.347f, 25875.0f},
+	{(2609.0f / BASIC_SR_REF), 0.0007f, 0.977f, 3164.0f},
+	{(2851.0f / BASIC_SR_REF), 0.0013f, 2.129f, 4747.0f},
+	{(3067.0f / BASIC_SR_REF), 0.0008f, 3.641f, 6168.0f},
+	{(3389.0f / BASIC_SR_REF), 0.0016f, 1.289f, 23965.0f},
+	{(3761.0f / BASIC_SR_REF), 0.0010f, 2.477f, 3801.0f}
 };
 static int DelayLineMaxSamples(float32_t sr, float32_t i_pitch_mod, int n);
-static int DelayLineBytesAlloc(float32_t sr, float32_t i_pitch_mod, int n);
 static const float32_t kOutputGain = 0.35f;
-static const float32_t kJpScale = 0.25f;
 
 extern uint8_t external_psram_size;
 
-AudioEffectReverbSC_i16::AudioEffectReverbSC_i16(bool use_psram) : AudioStream(2, inputQueueArray)
+AudioEffectReverbSC_i16::AudioEffectReverbSC_i16(bool use_psram, uint32_t lines, float32_t mod_depth_max, float32_t sample_rate) : AudioStream(2, inputQueueArray)
 {
-	sample_rate_ = AUDIO_SAMPLE_RATE_EXACT;
+	if (lines != 4 && lines != 16) lines = 8;
+	lines_ = lines;
+	jp_scale_ = 2.0f / (float32_t)lines;
+	out_gain_ = sqrtf(8.0f / (float32_t)lines);
+	sample_rate_ = sample_rate;
 	feedback_ = 0.7f;
 	lpfreq_ = 10000;
-	i_pitch_mod_ = 1;
+	mod_depth_max_ = max(mod_depth_max, 0.0f);
+	i_pitch_mod_ = min(1.0f, mod_depth_max_);
 	damp_fact_ = 0.195847f; // ~16kHz
 	flags.mem_fail = 0;
 	flags.bypass = 0;
 	flags.freeze = 0;
 	flags.cleanup_done = 1;
 	flags.memsetup_done = 0;
+	flags.autoIdle = 0;
 	bp_mode = BYPASS_MODE_PASS;
-	int i, n_bytes = 0;
-	n_bytes = 0;
+	int i, n_samples = 0;
+	int max_size = 0;
+	// allocate exactly the memory required by the delay lines for the sample rate and max modulation depth
+	aux_size = 0;
+	for (i = 0; i < (int)lines_; i++)	aux_size += DelayLineMaxSamples(sample_rate_, mod_depth_max_, i);
 	if (use_psram)	
 	{
 		#if ARDUINO_TEENSY41 
@@ -55,7 +71,7 @@ AudioEffectReverbSC_i16::AudioEffectReverbSC_i16(bool use_psram) : AudioStream(2
 			initialized = true;
 			return;
 		}
-		aux_ = (float32_t *) extmem_malloc(aux_size_bytes);
+		aux_ = (reverbsc_dly_t *) extmem_malloc(aux_size * sizeof(reverbsc_dly_t));
 		#else
 			flags.mem_fail = 1;
 			initialized = true;
@@ -64,7 +80,7 @@ AudioEffectReverbSC_i16::AudioEffectReverbSC_i16(bool use_psram) : AudioStream(2
 	}
 	else			
 	{
-		aux_ = (float32_t *) malloc(aux_size_bytes);
+		aux_ = (reverbsc_dly_t *) malloc(aux_size * sizeof(reverbsc_dly_t));
 	}
 	if (!aux_) 
 	{
@@ -72,14 +88,15 @@ AudioEffectReverbSC_i16::AudioEffectReverbSC_i16(bool use_psram) : AudioStream(2
 		return;
 	}
 
-	for (i = 0; i < 8; i++)
+	for (i = 0; i < (int)lines_; i++)
 	{
-		if (n_bytes > REVERBSC_I16_DLYBUF_SIZE)
-			return;
-		delay_lines_[i].buf = (aux_) + n_bytes;
-		InitDelayLine(&delay_lines_[i], i);
-		n_bytes += DelayLineBytesAlloc(AUDIO_SAMPLE_RATE_EXACT, 1, i);
+		dl_.buf[i] = (aux_) + n_samples;
+		InitDelayLine(i);
+		n_samples += dl_.buffer_size[i];
+		if (dl_.buffer_size[i] > max_size) max_size = dl_.buffer_size[i];
 	}
+	// longest delay line has to be flushed before going idle
+	idle.init(max_size / AUDIO_BLOCK_SAMPLES + 1);
 	mix(0.5f);
 
 	initialized = true;
@@ -94,64 +111,76 @@ static int DelayLineMaxSamples(float32_t sr, float32_t i_pitch_mod, int n)
 	return (int)(max_del * sr + 16.5);
 }
 
-static int DelayLineBytesAlloc(float32_t sr, float32_t i_pitch_mod, int n)
-{
-	int n_bytes = 0;
-
-	n_bytes += (DelayLineMaxSamples(sr, i_pitch_mod, n) * (int)sizeof(float32_t));
-	return n_bytes;
-}
-
-void AudioEffectReverbSC_i16::NextRandomLineseg(ReverbScDl_t *lp, int n)
+/**
+ * @brief Start a new random delay time segment, called at the block boundaries.
+ * 		All the constants are precomputed in InitDelayLine, no divisions here.
+ * 
+ * @param n delay line
+ * @param len_inv 1 / segment length in samples
+ */
+void AudioEffectReverbSC_i16::NextRandomLineseg(int n, float32_t len_inv)
 {
 	float32_t prv_del, nxt_del, phs_inc_val;
 
 	/* update random seed */
-	if (lp->seed_val < 0)
-		lp->seed_val += 0x10000;
-	lp->seed_val = (lp->seed_val * 15625 + 1) & 0xFFFF;
-	if (lp->seed_val >= 0x8000)
-		lp->seed_val -= 0x10000;
-	/* length of next segment in samples */
-	lp->rand_line_cnt = (int)((sample_rate_ / kReverbParams[n][2]) + 0.5f);
-	prv_del = (float32_t)lp->write_pos;
-	prv_del -= ((float32_t)lp->read_pos + ((float32_t)lp->read_pos_frac / (float32_t)DELAYPOS_SCALE));
-	while (prv_del < 0.0)
-		prv_del += lp->buffer_size;
-	prv_del = prv_del / sample_rate_; /* previous delay time in seconds */
-	nxt_del = (float32_t)lp->seed_val * kReverbParams[n][1] / 32768.0f;
-	/* next delay time in seconds */
-	nxt_del = kReverbParams[n][0] + (nxt_del * (float32_t)i_pitch_mod_);
+	if (dl_.seed_val[n] < 0)
+		dl_.seed_val[n] += 0x10000;
+	dl_.seed_val[n] = (dl_.seed_val[n] * 15625 + 1) & 0xFFFF;
+	if (dl_.seed_val[n] >= 0x8000)
+		dl_.seed_val[n] -= 0x10000;
+	/* previous delay time in samples */
+	prv_del = (float32_t)dl_.write_pos[n];
+	prv_del -= ((float32_t)dl_.read_pos[n] + ((float32_t)dl_.read_pos_frac[n] * (1.0f / (float32_t)DELAYPOS_SCALE)));
+	while (prv_del < 0.0f)
+		prv_del += dl_.buffer_size[n];
+	/* next delay time in samples */
+	nxt_del = dl_.del_base[n] + (float32_t)dl_.seed_val[n] * dl_.del_var[n];
 	/* calculate phase increment per sample */
-	phs_inc_val = (prv_del - nxt_del) / (float32_t)lp->rand_line_cnt;
-	phs_inc_val = phs_inc_val * sample_rate_ + 1.0;
-	lp->read_pos_frac_inc = (int)(phs_inc_val * DELAYPOS_SCALE + 0.5f);
+	phs_inc_val = (prv_del - nxt_del) * len_inv + 1.0f;
+	dl_.read_pos_frac_inc[n] = (int)(phs_inc_val * DELAYPOS_SCALE + 0.5f);
+}
+
+/**
+ * @brief random delay variation in samples per seed unit for the current modulation depth
+ */
+float32_t AudioEffectReverbSC_i16::DelayVariation(int n)
+{
+	return kReverbParams[n][1] * (float32_t)i_pitch_mod_ * sample_rate_ / 32768.0f;
 }
 
-void AudioEffectReverbSC_i16::InitDelayLine(ReverbScDl_t *lp, int n)
+void AudioEffectReverbSC_i16::InitDelayLine(int n)
 {
 	float32_t read_pos;
+	int32_t len;
 
 	/* calculate length of delay line */
-	lp->buffer_size = DelayLineMaxSamples(sample_rate_, 1, n);
-	lp->dummy = 0;
-	lp->write_pos = 0;
+	dl_.buffer_size[n] = DelayLineMaxSamples(sample_rate_, mod_depth_max_, n);
+	dl_.write_pos[n] = 0;
 	/* set random seed */
-	lp->seed_val = (int)(kReverbParams[n][3] + 0.5f);
+	dl_.seed_val[n] = (int)(kReverbParams[n][3] + 0.5f);
 	/* set initial delay time */
-	read_pos = (float32_t)lp->seed_val * kReverbParams[n][1] / 32768.0f;
+	read_pos = (float32_t)dl_.seed_val[n] * kReverbParams[n][1] / 32768.0f;
 	read_pos = kReverbParams[n][0] + (read_pos * (float32_t)i_pitch_mod_);
-	read_pos = (float32_t)lp->buffer_size - (read_pos * sample_rate_);
-	lp->read_pos = (int)read_pos;
-	read_pos = (read_pos - (float32_t)lp->read_pos) * (float32_t)DELAYPOS_SCALE;
-	lp->read_pos_frac = (int)(read_pos + 0.5);
-	/* initialise first random line segment */
-	NextRandomLineseg(lp, n);
+	read_pos = (float32_t)dl_.buffer_size[n] - (read_pos * sample_rate_);
+	dl_.read_pos[n] = (int)read_pos;
+	read_pos = (read_pos - (float32_t)dl_.read_pos[n]) * (float32_t)DELAYPOS_SCALE;
+	dl_.read_pos_frac[n] = (int)(read_pos + 0.5);
+	/* random segment constants, the segments are updated at block boundaries, 
+	   each line has its own slot, one line per block */
+	dl_.del_base[n] = kReverbParams[n][0] * sample_rate_;
+	dl_.del_var[n] = DelayVariation(n);
+	len = (int32_t)((sample_rate_ / kReverbParams[n][2]) / (float32_t)(lines_ * AUDIO_BLOCK_SAMPLES) + 0.5f);
+	if (len < 1) len = 1;
+	dl_.rand_line_len[n] = len;
+	dl_.rand_line_inv[n] = 1.0f / (float32_t)(len * lines_ * AUDIO_BLOCK_SAMPLES);
+	/* initialise first random line segment, it ends at the first visit of the line slot */
+	dl_.rand_line_cnt[n] = 1;
+	NextRandomLineseg(n, 1.0f / (float32_t)((n + 1) * AUDIO_BLOCK_SAMPLES));
 	/* clear delay line to zero */
-	lp->filter_state = 0.0f;
-	for (int i = 0; i < lp->buffer_size; i++)
+	dl_.filter_state[n] = 0.0f;
+	for (int i = 0; i < dl_.buffer_size[n]; i++)
 	{
-		lp->buf[i] = 0;
+		dl_.buf[n][i] = 0;
 	}
 }
 
@@ -160,13 +189,18 @@ void AudioEffectReverbSC_i16::update()
 #if defined(__IMXRT1062__)
 	audio_block_t *blockL, *blockR;
 	int16_t i;
-	float32_t a_in_l, a_in_r, a_out_l, a_out_r, dryL, dryR;
-	float32_t vm1, v0, v1, v2, am1, a0, a1, a2, frac;
-	ReverbScDl_t *lp;
-	int read_pos;
+	float32_t a_in[2], a_out_l, a_out_r, dryL, dryR;
+	float32_t frac[REVERBSC_I16_LINES_MAX];
+	float32_t am1[REVERBSC_I16_LINES_MAX], a0[REVERBSC_I16_LINES_MAX], a1[REVERBSC_I16_LINES_MAX], a2[REVERBSC_I16_LINES_MAX];
+	float32_t vm1[REVERBSC_I16_LINES_MAX], v0[REVERBSC_I16_LINES_MAX], v1[REVERBSC_I16_LINES_MAX], v2[REVERBSC_I16_LINES_MAX];
+	const uint32_t lines = lines_;
+	reverbsc_dly_t *buf;
+	int32_t read_pos, buffer_size;
 	uint32_t n;
-	int buffer_size; /* Local copy */
 	float32_t damp_fact = damp_fact_;
+	float32_t feedback = feedback_;
+	const float32_t out_gain = out_gain_;
+	float32_t wet_peak = 0.0f;		// tank output level for the auto idle
 	
 	if (!initialized) return;
 	// special case if memory allocation failed, pass the input signal directly to the output
@@ -174,7 +208,16 @@ void AudioEffectReverbSC_i16::update()
 	
 	blockL = receiveWritable(0);
 	blockR = receiveWritable(1);
-	
+	// auto idle: silent input and decayed tail, skip the processing, no blocks transmitted
+	if (flags.autoIdle && !flags.bypass && flags.memsetup_done)
+	{
+		if (idle.skip(blockL, blockR))
+		{
+			if (blockL) release(blockL);
+			if (blockR) release(blockR);
+			return;
+		}
+	}
 	if (!bypass_process(&blockL, &blockR, bp_mode, (bool)flags.bypass))
 		return;
 
@@ -189,100 +232,121 @@ void AudioEffectReverbSC_i16::update()
 	}
 
 	flags.cleanup_done = 0;
+	/* random line segments: one delay line per block can start a new segment */
+	n = rand_line_slot;
+	if (--dl_.rand_line_cnt[n] <= 0)
+	{
+		dl_.rand_line_cnt[n] = dl_.rand_line_len[n];
+		NextRandomLineseg(n, dl_.rand_line_inv[n]);
+	}
+	if (++rand_line_slot >= lines) rand_line_slot = 0;
+
 	for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
 	{
 		input_gain += (input_gain_set - input_gain) * 0.25f;
 		/* calculate "resultant junction pressure" and mix to input signals */
-		a_in_l = a_out_l = a_out_r = 0.0f;
+		a_in[0] = a_out_l = a_out_r = 0.0f;
 		dryL = ((float32_t)blockL->data[i] / 32768.0f) * input_gain;
 		dryR = ((float32_t)blockR->data[i] / 32768.0f) * input_gain;
 
-		for (n = 0; n < 8; n++)
+		for (n = 0; n < lines; n++)
 		{
-			a_in_l += delay_lines_[n].filter_state;
+			a_in[0] += dl_.filter_state[n];
 		}
-		a_in_l *= kJpScale;
-		a_in_r = a_in_l + dryR;
-		a_in_l = a_in_l + dryL;
+		a_in[0] *= jp_scale_;
+		a_in[1] = a_in[0] + dryR;
+		a_in[0] = a_in[0] + dryL;
 
-		/* loop through all delay lines */
-		for (n = 0; n < 8; n++)
+		/* send input signal and feedback to the delay lines, even lines L, odd lines R */
+		for (n = 0; n < lines; n++)
 		{
-			lp = &delay_lines_[n];
-			buffer_size = lp->buffer_size;
-
-			/* send input signal and feedback to delay line */
-			lp->buf[lp->write_pos] = (float32_t)((n & 1 ? a_in_r : a_in_l) - lp->filter_state);
-			if (++lp->write_pos >= buffer_size) 	lp->write_pos -= buffer_size;
-
-			/* read from delay line with cubic interpolation */
-			if (lp->read_pos_frac >= DELAYPOS_SCALE)
+#if REVERBSC_I16_DLY_Q15
+			dl_.buf[n][dl_.write_pos[n]] = (int16_t)signed_saturate_rshift((int32_t)((a_in[n & 1] - dl_.filter_state[n]) * REVERBSC_I16_DLY_SCALE), 16, 0);
+#else
+			dl_.buf[n][dl_.write_pos[n]] = a_in[n & 1] - dl_.filter_state[n];
+#endif
+			if (++dl_.write_pos[n] >= dl_.buffer_size[n]) 	dl_.write_pos[n] -= dl_.buffer_size[n];
+		}
+		/* update the read positions */
+		for (n = 0; n < lines; n++)
+		{
+			if (dl_.read_pos_frac[n] >= DELAYPOS_SCALE)
 			{
-				lp->read_pos += (lp->read_pos_frac >> DELAYPOS_SHIFT);
-				lp->read_pos_frac &= DELAYPOS_MASK;
+				dl_.read_pos[n] += (dl_.read_pos_frac[n] >> DELAYPOS_SHIFT);
+				dl_.read_pos_frac[n] &= DELAYPOS_MASK;
 			}
-			if (lp->read_pos >= buffer_size)
-				lp->read_pos -= buffer_size;
-			read_pos = lp->read_pos;
-			frac = (float32_t)lp->read_pos_frac * (1.0f / (float32_t)DELAYPOS_SCALE);
-
-			/* calculate interpolation coefficients */
-			a2 = frac * frac;
-			a2 *= (1.0f / 6.0f);
-			a1 = frac;
-			a1 += 1.0f;
-			a1 *= 0.5f;
-			am1 = a1 - 1.0f;
-			a0 = 3.0f * a2;
-			a1 -= a0;
-			am1 -= a2;
-			a0 -= frac;
-
-			/* read four samples for interpolation */
+			if (dl_.read_pos[n] >= dl_.buffer_size[n])
+				dl_.read_pos[n] -= dl_.buffer_size[n];
+		}
+		/* calculate cubic interpolation coefficients */
+		for (n = 0; n < lines; n++)
+		{
+			frac[n] = (float32_t)dl_.read_pos_frac[n] * (1.0f / (float32_t)DELAYPOS_SCALE);
+			a2[n] = frac[n] * frac[n] * (1.0f / 6.0f);
+			a1[n] = (frac[n] + 1.0f) * 0.5f;
+			am1[n] = a1[n] - 1.0f - a2[n];
+			a0[n] = 3.0f * a2[n];
+			a1[n] -= a0[n];
+			a0[n] -= frac[n];
+#if REVERBSC_I16_DLY_Q15
+			/* fold the fraction and the Q15 to float conversion into the coefficients */
+			am1[n] *= frac[n] * (1.0f / REVERBSC_I16_DLY_SCALE);
+			a0[n] = (a0[n] * frac[n] + 1.0f) * (1.0f / REVERBSC_I16_DLY_SCALE);
+			a1[n] *= frac[n] * (1.0f / REVERBSC_I16_DLY_SCALE);
+			a2[n] *= frac[n] * (1.0f / REVERBSC_I16_DLY_SCALE);
+#endif
+		}
+		/* read four samples for interpolation */
+		for (n = 0; n < lines; n++)
+		{
+			buf = dl_.buf[n];
+			read_pos = dl_.read_pos[n];
+			buffer_size = dl_.buffer_size[n];
 			if (read_pos > 0 && read_pos < (buffer_size - 2))
 			{
-				vm1 = (float32_t)(lp->buf[read_pos - 1]);
-				v0 = (float32_t)(lp->buf[read_pos]);
-				v1 = (float32_t)(lp->buf[read_pos + 1]);
-				v2 = (float32_t)(lp->buf[read_pos + 2]);
+				vm1[n] = buf[read_pos - 1];
+				v0[n] = buf[read_pos];
+				v1[n] = buf[read_pos + 1];
+				v2[n] = buf[read_pos + 2];
 			}
 			else
 			{
 				/* at buffer wrap-around, need to check index */
 				if (--read_pos < 0)	read_pos += buffer_size;
-				vm1 = (float32_t)lp->buf[read_pos];
+				vm1[n] = buf[read_pos];
 				if (++read_pos >= buffer_size) read_pos -= buffer_size;
-				v0 = (float32_t)lp->buf[read_pos];
+				v0[n] = buf[read_pos];
 				if (++read_pos >= buffer_size) read_pos -= buffer_size;
-				v1 = (float32_t)lp->buf[read_pos];
+				v1[n] = buf[read_pos];
 				if (++read_pos >= buffer_size) read_pos -= buffer_size;
-				v2 = (float32_t)lp->buf[read_pos];
-			}
-			v0 = (am1 * vm1 + a0 * v0 + a1 * v1 + a2 * v2) * frac + v0;
-
-			/* update buffer read position */
-			lp->read_pos_frac += lp->read_pos_frac_inc;
-
-			// apply filter			
-			v0 = (lp->filter_state - v0) * damp_fact + v0;
-
-			/* mix to output */
-			if (n & 1) 	a_out_r += v0;
-			else		a_out_l += v0;
-
-			v0 *= (float32_t)feedback_; // apply feedback
-			lp->filter_state = v0;	// save filter - this will make the reverb volume constant
-
-			/* start next random line segment if current one has reached endpoint */
-			if (--(lp->rand_line_cnt) <= 0)
-			{
-				NextRandomLineseg(lp, n);
+				v2[n] = buf[read_pos];
 			}
 		}
-
+		/* interpolate, apply the damping filter and feedback */
+		for (n = 0; n < lines; n++)
+		{
+#if REVERBSC_I16_DLY_Q15
+			v0[n] = am1[n] * vm1[n] + a0[n] * v0[n] + a1[n] * v1[n] + a2[n] * v2[n];
+#else
+			v0[n] = (am1[n] * vm1[n] + a0[n] * v0[n] + a1[n] * v1[n] + a2[n] * v2[n]) * frac[n] + v0[n];
+#endif
+			v0[n] = (dl_.filter_state[n] - v0[n]) * damp_fact + v0[n];
+			dl_.filter_state[n] = v0[n] * feedback;	// save filter - this will make the reverb volume constant
+			dl_.read_pos_frac[n] += dl_.read_pos_frac_inc[n];
+		}
+		/* mix to output */
+		for (n = 0; n < lines; n += 2)
+		{
+			a_out_l += v0[n];
+			a_out_r += v0[n + 1];
+		}
+		a_out_l *= out_gain;
+		a_out_r *= out_gain;
+		wet_peak = fmaxf(wet_peak, fmaxf(fabsf(a_out_l), fabsf(a_out_r)));
 		blockL->data[i] = (int16_t)((a_out_l * wet_gain + dryL * dry_gain) * 32767.0f);
 		blockR->data[i] = (int16_t)((a_out_r * wet_gain + dryR * dry_gain) * 32767.0f);
 	} // end block processing
+	if (flags.autoIdle) idle.update(wet_peak);
     AudioStream::transmit(blockL, 0);
 	AudioStream::transmit(blockR, 1);
 	AudioStream::release(blockL);
@@ -330,13 +394,13 @@ void AudioEffectReverbSC_i16::freeze(bool state)
 bool AudioEffectReverbSC_i16::memCleanup()
 {
 	bool result = false;
-	if (memCleanupEnd > REVERBSC_I16_DLYBUF_SIZE) // last segment
+	if (memCleanupEnd > aux_size) // last segment
 	{
-		memCleanupEnd = REVERBSC_I16_DLYBUF_SIZE;
+		memCleanupEnd = aux_size;
 		result = true;	
 	}
-	uint32_t l = (memCleanupEnd - memCleanupStart) * sizeof(float32_t);
-	uint8_t* memPtr = (uint8_t *)&aux_[0]+(memCleanupStart*sizeof(float32_t));
+	uint32_t l = (memCleanupEnd - memCleanupStart) * sizeof(reverbsc_dly_t);
+	uint8_t* memPtr = (uint8_t *)&aux_[0]+(memCleanupStart*sizeof(reverbsc_dly_t));
 	memset(memPtr, 0, l);
 	arm_dcache_flush_delete(memPtr, l);
 
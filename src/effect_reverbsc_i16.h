@@ -22,27 +22,55 @@
 #include "arm_math.h"
 #include "basic_components.h"
 
-#define REVERBSC_I16_DLYBUF_SIZE 98936
+#define REVERBSC_I16_LINES		(8)		// default number of delay lines in the feedback network
+#define REVERBSC_I16_LINES_MAX	(16)
+
+#ifndef REVERBSC_I16_DLY_Q15
+	#define REVERBSC_I16_DLY_Q15	0		// 1 = int16_t delay line storage, half the memory and PSRAM traffic
+#endif
+#define REVERBSC_I16_DLY_SCALE	(32768.0f / 4)	// float to Q15 delay storage scaling, 12dB headroom for the feedback network
+
+#if REVERBSC_I16_DLY_Q15
+typedef int16_t reverbsc_dly_t;
+#else
+typedef float32_t reverbsc_dly_t;
+#endif
 
 class AudioEffectReverbSC_i16 : public AudioStream
 {
 public:
-	AudioEffectReverbSC_i16(bool use_psram = false);
+	/**
+	 * @brief Construct a new ReverbSC, the delay memory is allocated for the given settings
+	 * 
+	 * @param use_psram 	place the delay lines in PSRAM
+	 * @param lines 		number of delay lines: 4 (light ambience), 8 (default) or 16 (dense hall)
+	 * @param mod_depth_max largest delay time modulation depth used with mod_depth(), 1.0f = default
+	 * @param sample_rate 	sample rate the delay times are calculated for
+	 */
+	AudioEffectReverbSC_i16(bool use_psram = false, uint32_t lines = REVERBSC_I16_LINES, 
+							float32_t mod_depth_max = 1.0f, float32_t sample_rate = AUDIO_SAMPLE_RATE_EXACT);
 	~AudioEffectReverbSC_i16(){};
 	virtual void update();
 
+	/**
+	 * @brief delay network state, structure of arrays with one lane per delay line
+	 * 		to let the per sample processing run as simple loops over all lines
+	 */
 	typedef struct
 	{
-		int    write_pos;         /**< write position */
-		int    buffer_size;       /**< buffer size */
-		int    read_pos;          /**< read position */
-		int    read_pos_frac;     /**< fractional component of read pos */
-		int    read_pos_frac_inc; /**< increment for fractional */
-		int    dummy;             /**<  dummy var */
-		int    seed_val;          /**< randseed */
-		int    rand_line_cnt;     /**< number of random lines */
-		float32_t  filter_state;      /**< state of filter */
-		float32_t *buf;               /**< buffer ptr */
+		int32_t    write_pos[REVERBSC_I16_LINES_MAX];         /**< write position */
+		int32_t    buffer_size[REVERBSC_I16_LINES_MAX];       /**< buffer size */
+		int32_t    read_pos[REVERBSC_I16_LINES_MAX];          /**< read position */
+		int32_t    read_pos_frac[REVERBSC_I16_LINES_MAX];     /**< fractional component of read pos */
+		int32_t    read_pos_frac_inc[REVERBSC_I16_LINES_MAX]; /**< increment for fractional */
+		int32_t    seed_val[REVERBSC_I16_LINES_MAX];          /**< randseed */
+		int32_t    rand_line_cnt[REVERBSC_I16_LINES_MAX];     /**< remaining visits of the current random segment */
+		int32_t    rand_line_len[REVERBSC_I16_LINES_MAX];     /**< random segment length in visits, one visit every lines_ blocks */
+		float32_t  rand_line_inv[REVERBSC_I16_LINES_MAX];     /**< 1 / random segment length in samples */
+		float32_t  del_base[REVERBSC_I16_LINES_MAX];          /**< delay time in samples */
+		float32_t  del_var[REVERBSC_I16_LINES_MAX];           /**< random delay variation in samples per seed unit */
+		float32_t  filter_state[REVERBSC_I16_LINES_MAX];      /**< state of filter */
+		reverbsc_dly_t *buf[REVERBSC_I16_LINES_MAX];          /**< buffer ptr */
 	} ReverbScDl_t;
 
 	inline void feedback(const float32_t &fb) 
@@ -72,6 +100,22 @@ public:
 		}	
 	}
 
+	/**
+	 * @brief delay time modulation depth
+	 * 
+	 * @param depth 0.0f (no modulation) to mod_depth_max set in the constructor, 1.0f = default
+	 */
+	void mod_depth(float32_t depth)
+	{
+		depth = constrain(depth, 0.0f, mod_depth_max_);
+		__disable_irq();
+		i_pitch_mod_ = depth;
+		for (uint32_t n = 0; n < lines_; n++) dl_.del_var[n] = DelayVariation(n);
+		__enable_irq();
+	}
+	float32_t mod_depth_get() {return i_pitch_mod_;}
+	uint32_t lines_get() {return lines_;}
+
     void mix(float32_t mix)
     {
 		mix = constrain(mix, 0.0f, 1.0f);
@@ -133,6 +177,33 @@ public:
 		bypass_set(flags.bypass^1);
         return flags.bypass;
     }
+	/**
+	 * @brief enables the automatic idle mode. If the input is silent and the reverb tail
+	 * 		has decayed below the threshold, the processing is skipped and no audio blocks
+	 * 		are transmitted. The first non silent input block resumes the processing.
+	 * 
+	 * @param state true = enabled
+	 */
+	void autoIdle_set(bool state)
+	{
+		__disable_irq();
+		flags.autoIdle = state;
+		idle.reset();
+		__enable_irq();
+	}
+	bool autoIdle_get() {return flags.autoIdle;}
+	/**
+	 * @brief sets the silence threshold used by the auto idle mode
+	 * 
+	 * @param thr max absolute sample value treated as silence
+	 */
+	void autoIdle_threshold(int16_t thr)
+	{
+		__disable_irq();
+		idle.threshold(thr);
+		__enable_irq();
+	}
+	bool idle_get() {return idle.get();}
 
 private:
     struct flags_t
@@ -142,11 +213,12 @@ private:
 		unsigned cleanup_done:		1;
 		unsigned memsetup_done:		1;
 		unsigned mem_fail:			1;
+		unsigned autoIdle:			1;
     }flags;
 	bypass_mode_t bp_mode;
 	audio_block_t *inputQueueArray[2];
-    void NextRandomLineseg(ReverbScDl_t *lp, int n);
-    void InitDelayLine(ReverbScDl_t *lp, int n);
+    void NextRandomLineseg(int n, float32_t len_inv);
+    void InitDelayLine(int n);
 	//void bypass_process();
     float32_t feedback_, feedback_tmp;
 	float32_t lpfreq_;
@@ -154,9 +226,15 @@ private:
     float32_t sample_rate_;
     float32_t damp_fact_, damp_fact_tmp;
     bool initialized = false;
-    ReverbScDl_t delay_lines_[8];
-    float32_t *aux_; // main delay line storage buffer, placed either in RAM2 or PSRAM
-	const uint32_t aux_size_bytes = REVERBSC_I16_DLYBUF_SIZE*sizeof(float32_t);
+    ReverbScDl_t dl_;
+	uint32_t rand_line_slot = 0;	// delay line starting a new random segment in the next block
+	uint32_t lines_;				// number of delay lines
+	float32_t mod_depth_max_;
+	float32_t jp_scale_;			// junction pressure scaling, 2/lines
+	float32_t out_gain_;			// keeps the output level independent of the line count
+	float32_t DelayVariation(int n);
+    reverbsc_dly_t *aux_; // main delay line storage buffer, placed either in RAM2 or PSRAM
+	uint32_t aux_size;	// delay lines memory size in samples
 	float32_t dry_gain = 0.5f;
 	float32_t wet_gain = 0.5f;
 
@@ -171,6 +249,8 @@ private:
 	uint32_t memCleanupStart = 0;
 	uint32_t memCleanupEnd = memCleanupStep;
 
+	AudioBasicIdle idle;
+
 	bool bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state);
 };
 #endif // _EFFECT_REVERBSC_I16_H_
@@ -55,18 +55,18 @@ AudioEffectSpringReverb_i16::AudioEffectSpringReverb_i16() : AudioStream(2, inpu
 	if(!lp_dly1.init(SPRVB_DLY1_LEN)) memOK = false;
 	if(!lp_dly2.init(SPRVB_DLY2_LEN)) memOK = false;
 	// chirp allpass chain
-	sp_chrp_alp1_buf = (float *)malloc(SPRVB_CHIRP_AMNT*SPRVB_CHIRP1_LEN*sizeof(float));
-	sp_chrp_alp2_buf = (float *)malloc(SPRVB_CHIRP_AMNT*SPRVB_CHIRP2_LEN*sizeof(float));
-	sp_chrp_alp3_buf = (float *)malloc(SPRVB_CHIRP_AMNT*SPRVB_CHIRP3_LEN*sizeof(float));
-	sp_chrp_alp4_buf = (float *)malloc(SPRVB_CHIRP_AMNT*SPRVB_CHIRP4_LEN*sizeof(float));
-	if (!sp_chrp_alp1_buf) memOK = false;
-	if (!sp_chrp_alp2_buf) memOK = false;
-	if (!sp_chrp_alp3_buf) memOK = false;
-	if (!sp_chrp_alp4_buf) memOK = false;
-	memset(&sp_chrp_alp1_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP1_LEN*sizeof(float));
-	memset(&sp_chrp_alp2_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP2_LEN*sizeof(float));
-	memset(&sp_chrp_alp3_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP3_LEN*sizeof(float));
-	memset(&sp_chrp_alp4_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP4_LEN*sizeof(float));
+	const uint32_t chrp_len[4] = {SPRVB_CHIRP1_LEN, SPRVB_CHIRP2_LEN, SPRVB_CHIRP3_LEN, SPRVB_CHIRP4_LEN};
+	for (int i = 0; i < 4; i++)
+	{
+		if (!sp_chrp_bank[i].init(chrp_len[i], SPRVB_CHIRP_AMNT_MAX/2)) memOK = false;
+		// the L chain runs the coeffs forward, R backwards, the last group uses a different L set
+		for (int j = 0; j < SPRVB_CHIRP_AMNT_MAX/2; j++)
+		{
+			sp_chrp_bank[i].coeff(j, chrp_allp_k[(i == 3 && (j & 3) == 2) ? 1 : (j & 3)], chrp_allp_k[3 - (j & 3)]);
+		}
+		sp_chrp_bank[i].stages_set(SPRVB_CHIRP_AMNT/2);
+		sp_chrp_bank[i].stages_update();
+	}
 	in_BassCut_k = 0.0f;
 	in_TrebleCut_k = 0.95f;
 	lp_BassCut_k = 0.0f;
@@ -76,6 +76,7 @@ AudioEffectSpringReverb_i16::AudioEffectSpringReverb_i16() : AudioStream(2, inpu
 	flt_lp2.init(BASS_LOSS_FREQ, &lp_BassCut_k, TREBLE_LOSS_FREQ, &lp_TrebleCut_k);
 	mix(0.5f);
 	cleanup_done = true;
+	idle.init(IDLE_HOLD_BLOCKS);
 	if (memOK) initialized = true;
 }
 
@@ -83,42 +84,49 @@ void AudioEffectSpringReverb_i16::update()
 {   
 #if defined(__IMXRT1062__)
 	audio_block_t *blockL, *blockR;
-	int i, j;
-	float32_t inL, inR, dryL, dryR;
-	float32_t acc;
-    float32_t lp_out1, lp_out2, mono_in, dry_in;
+	int i;
+	float32_t inL, inR;
+	float32_t dryL[AUDIO_BLOCK_SAMPLES], dryR[AUDIO_BLOCK_SAMPLES], mono_in[AUDIO_BLOCK_SAMPLES];
+	float32_t acc, in_gain_k;
+	float32_t wet_peak = 0.0f;		// tank output level for the auto idle
+    float32_t lp_out1, lp_out2;
     float32_t rv_time;
-	uint32_t allp_idx;
 	uint32_t offset;
 	float lfo_fr;	
+	float32_t xf;
+	bool bypass, chirp_xf;
     if (!initialized) return;
 
 	blockL = receiveWritable(0);
 	blockR = receiveWritable(1);
-	if (!bypass_process(&blockL, &blockR, bp_mode, bp))
+	bypass = bp || cleanupBusy;		// stay bypassed until the cleanup is finished
+	// auto idle: silent input and decayed tail, skip the processing, no blocks transmitted
+	// input blocks in TRAILS bypass mode are discarded, treat them as silence
+	if (autoIdle && (!bypass || bp_mode == BYPASS_MODE_TRAILS))
+	{
+		if (idle.skip(bypass ? NULL : blockL, bypass ? NULL : blockR))
+		{
+			if (blockL) release(blockL);
+			if (blockR) release(blockR);
+			lfo.update(AUDIO_BLOCK_SAMPLES);	// keep the modulation running, resume in phase
+			return;
+		}
+	}
+	if (!bypass_process(&blockL, &blockR, bp_mode, bypass))
 		return;
 
-    if (bp)
+    if (bypass)
     {
+		// the buffers are cleared over the next few blocks
 		if (!cleanup_done && bp_mode != BYPASS_MODE_TRAILS)
 		{
-			sp_lp_allp1a.reset();
-			sp_lp_allp1b.reset();
-			sp_lp_allp1c.reset();
-			sp_lp_allp1d.reset();
-			sp_lp_allp2a.reset();
-			sp_lp_allp2b.reset();
-			sp_lp_allp2c.reset();
-			sp_lp_allp2d.reset();
-			lp_dly1.reset();
-			lp_dly2.reset();
-			memset(&sp_chrp_alp1_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP1_LEN*sizeof(float));
-			memset(&sp_chrp_alp2_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP2_LEN*sizeof(float));
-			memset(&sp_chrp_alp3_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP3_LEN*sizeof(float));
-			memset(&sp_chrp_alp4_buf[0], 0, SPRVB_CHIRP_AMNT*SPRVB_CHIRP4_LEN*sizeof(float));			
+			memCleanupIdx = 0;
+			memCleanupStart = 0;
+			cleanupBusy = true;
 			cleanup_done = true;
 		}
-		if (bp_mode != BYPASS_MODE_TRAILS)
+		if (cleanupBusy) cleanupBusy = !memCleanup();
+		if (bp_mode != BYPASS_MODE_TRAILS || cleanupBusy)
 		{
 			transmit(blockL, 0);
 			transmit(blockR, 1);
@@ -130,15 +138,23 @@ void AudioEffectSpringReverb_i16::update()
 	
 	cleanup_done = false;
     rv_time = rv_time_k;
+	// input conditioning: convert, sum to mono and filter the whole block
 	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
-    {  
-		lfo.update();
+	{
 		inputGain += (inputGainSet - inputGain) * 0.25f;
-		dryL = (float32_t)blockL->data[i] / 32780.0f;
-		dryR = (float32_t)blockR->data[i] / 32768.0f;
-		dry_in = (dryL + dryR) * inputGain;
+		dryL[i] = (float32_t)blockL->data[i] / 32768.0f;
+		dryR[i] = (float32_t)blockR->data[i] / 32768.0f;
+		mono_in[i] = (dryL[i] + dryR[i]) * inputGain;
+	}
+	flt_in.processBlock(mono_in, mono_in, AUDIO_BLOCK_SAMPLES);
+	in_gain_k = 1.0f + in_BassCut_k*-2.5f;		// compensate the level drop when cutting the bass
+	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) mono_in[i] *= in_gain_k;
+	// a new chirp stage count is crossfaded over this block
+	chirp_xf = sp_chrp_bank[0].stages_pending();
 
-		mono_in = flt_in.process(dry_in)* (1.0f + in_BassCut_k*-2.5f);
+	for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) 
+    {  
+		lfo.update();
 		acc = lp_dly1.getTap(0) * rv_time;
 		lp_out1 = flt_lp1.process(acc);
 
@@ -146,7 +162,7 @@ void AudioEffectSpringReverb_i16::update()
 		acc = sp_lp_allp1b.process(acc);
 		acc = sp_lp_allp1c.process(acc);
 		acc = sp_lp_allp1d.process(acc);
-		acc = lp_dly2.process(acc + mono_in) * rv_time;
+		acc = lp_dly2.process(acc + mono_in[i]) * rv_time;
 		lp_out2 = flt_lp2.process(acc);
 
 		acc = sp_lp_allp2a.process(lp_out2); 
@@ -154,221 +170,26 @@ void AudioEffectSpringReverb_i16::update()
 		acc = sp_lp_allp2c.process(acc);
 		acc = sp_lp_allp2d.process(acc);
 
-		lp_dly1.write_toOffset(acc + mono_in, 0);
+		lp_dly1.write_toOffset(acc + mono_in[i], 0);
 		lp_dly1.updateIndex();
 		
 		inL = inR = (lp_out1 + lp_out2);
 
-		j = 0;
-        while(j < SPRVB_CHIRP_AMNT)
-        {
-			// 1st 4 are left channel
-			allp_idx = j*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j];
-			acc = sp_chrp_alp1_buf[allp_idx] + inL * chrp_allp_k[0];
-			sp_chrp_alp1_buf[allp_idx] = inL - chrp_allp_k[0] * acc;
-            inL = acc;
-            if (++chrp_alp1_idx[j] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j] = 0;   
-            
-			allp_idx = (j+1)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+1];
-            acc = sp_chrp_alp1_buf[allp_idx]  + inL * chrp_allp_k[1];  
-            sp_chrp_alp1_buf[allp_idx] = inL - chrp_allp_k[1] * acc;			
-            inL = acc;
-            if (++chrp_alp1_idx[j+1] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+1] = 0; 
-            
-			allp_idx = (j+2)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+2];
-			acc = sp_chrp_alp1_buf[allp_idx]  + inL * chrp_allp_k[2];  
-            sp_chrp_alp1_buf[allp_idx] = inL - chrp_allp_k[2] * acc;
-            inL = acc;
-            if (++chrp_alp1_idx[j+2] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+2] = 0; 
-
-			allp_idx = (j+3)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+3];
-            acc = sp_chrp_alp1_buf[allp_idx]  + inL * chrp_allp_k[3];  
-            sp_chrp_alp1_buf[allp_idx] = inL - chrp_allp_k[3] * acc;
-            inL = acc;
-            if (++chrp_alp1_idx[j+3] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+3] = 0; 
-			// channel R
-			allp_idx = (j+4)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+4];
-            acc = sp_chrp_alp1_buf[allp_idx]  + inR * chrp_allp_k[3];  
-            sp_chrp_alp1_buf[allp_idx] = inR - chrp_allp_k[3] * acc;
-            inR = acc;
-            if (++chrp_alp1_idx[j+4] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+4] = 0; 
-
-			allp_idx = (j+5)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+5];
-            acc = sp_chrp_alp1_buf[allp_idx]  + inR * chrp_allp_k[2];  
-            sp_chrp_alp1_buf[allp_idx] = inR - chrp_allp_k[2] * acc;
-            inR = acc;
-            if (++chrp_alp1_idx[j+5] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+5] = 0; 
-
-			allp_idx = (j+6)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+6];
-            acc = sp_chrp_alp1_buf[allp_idx]  + inR * chrp_allp_k[1];  
-            sp_chrp_alp1_buf[allp_idx] = inR - chrp_allp_k[1] * acc;
-            inR = acc;
-            if (++chrp_alp1_idx[j+6] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+6] = 0; 
-
-			allp_idx = (j+7)*SPRVB_CHIRP1_LEN + chrp_alp1_idx[j+7];
-			acc = sp_chrp_alp1_buf[allp_idx]  + inR * chrp_allp_k[0];  
-            sp_chrp_alp1_buf[allp_idx] = inR - chrp_allp_k[0] * acc;			
-            inR = acc;
-            if (++chrp_alp1_idx[j+7] >= SPRVB_CHIRP1_LEN) chrp_alp1_idx[j+7] = 0; 
-
-            j = j + 8;
-        }
-        j = 0;
-        while(j < SPRVB_CHIRP_AMNT)
-        {	// channel L
-			allp_idx = j*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j];
-            acc = sp_chrp_alp2_buf[allp_idx]  + inL * chrp_allp_k[0];  
-            sp_chrp_alp2_buf[allp_idx] = inL - chrp_allp_k[0] * acc;
-            inL = acc;
-            if (++chrp_alp2_idx[j] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j] = 0;   
-            
-			allp_idx = (j+1)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+1];
-            acc = sp_chrp_alp2_buf[allp_idx]  + inL * chrp_allp_k[1];  
-            sp_chrp_alp2_buf[allp_idx] = inL - chrp_allp_k[1] * acc;			
-            inL = acc;
-            if (++chrp_alp2_idx[j+1] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+1] = 0; 
-            
-			allp_idx = (j+2)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+2];
-            acc = sp_chrp_alp2_buf[allp_idx]  + inL * chrp_allp_k[2];  
-            sp_chrp_alp2_buf[allp_idx] = inL - chrp_allp_k[2] * acc;			
-            inL = acc;
-            if (++chrp_alp2_idx[j+2] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+2] = 0; 
-            
-			allp_idx = (j+3)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+3];
-            acc = sp_chrp_alp2_buf[allp_idx]  + inL * chrp_allp_k[3];  
-            sp_chrp_alp2_buf[allp_idx] = inL - chrp_allp_k[3] * acc;			
-            inL = acc;
-            if (++chrp_alp2_idx[j+3] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+3] = 0; 
-			// channel R
-			allp_idx = (j+4)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+4];
-			acc = sp_chrp_alp2_buf[allp_idx]  + inR * chrp_allp_k[3];  
-            sp_chrp_alp2_buf[allp_idx] = inR - chrp_allp_k[3] * acc;
-            inR = acc;
-            if (++chrp_alp2_idx[j+4] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+4] = 0; 
-    
-			allp_idx = (j+5)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+5];
-			acc = sp_chrp_alp2_buf[allp_idx]  + inR * chrp_allp_k[2];  
-            sp_chrp_alp2_buf[allp_idx] = inR - chrp_allp_k[2] * acc;
-            inR = acc;
-            if (++chrp_alp2_idx[j+5] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+5] = 0; 
-
-			allp_idx = (j+6)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+6];
-			acc = sp_chrp_alp2_buf[allp_idx]  + inR * chrp_allp_k[1];  
-            sp_chrp_alp2_buf[allp_idx] = inR - chrp_allp_k[1] * acc;
-            inR = acc;
-            if (++chrp_alp2_idx[j+6] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+6] = 0; 
-
-			allp_idx = (j+7)*SPRVB_CHIRP2_LEN + chrp_alp2_idx[j+7];
-			acc = sp_chrp_alp2_buf[allp_idx]  + inR * chrp_allp_k[0];  
-            sp_chrp_alp2_buf[allp_idx] = inR - chrp_allp_k[0] * acc;
-            inR = acc;
-            if (++chrp_alp2_idx[j+7] >= SPRVB_CHIRP2_LEN) chrp_alp2_idx[j+7] = 0; 
-            j = j + 8;
-        }
-        j = 0;
-        while(j < SPRVB_CHIRP_AMNT)
-        {	// channel L
-			allp_idx = j*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inL * chrp_allp_k[0];  
-            sp_chrp_alp3_buf[allp_idx] = inL - chrp_allp_k[0] * acc;
-            inL = acc;
-            if (++chrp_alp3_idx[j] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j] = 0;   
-  
-			allp_idx = (j+1)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+1];
-			acc = sp_chrp_alp3_buf[allp_idx]  + inL * chrp_allp_k[1];  
-            sp_chrp_alp3_buf[allp_idx] = inL - chrp_allp_k[1] * acc;    
-            inL = acc;
-            if (++chrp_alp3_idx[j+1] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+1] = 0; 
-            
-			allp_idx = (j+2)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+2];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inL * chrp_allp_k[2];  
-            sp_chrp_alp3_buf[allp_idx] = inL - chrp_allp_k[2] * acc;			
-            inL = acc;
-            if (++chrp_alp3_idx[j+2] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+2] = 0; 
-
-			allp_idx = (j+3)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+3];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inL * chrp_allp_k[3];  
-            sp_chrp_alp3_buf[allp_idx] = inL - chrp_allp_k[3] * acc;			
-            inL = acc;
-            if (++chrp_alp3_idx[j+3] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+3] = 0; 
-			// channel R
-			allp_idx = (j+4)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+4];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inR * chrp_allp_k[3];  
-            sp_chrp_alp3_buf[allp_idx] = inR - chrp_allp_k[3] * acc;			
-            inR = acc;
-            if (++chrp_alp3_idx[j+4] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+4] = 0; 
-    
-			allp_idx = (j+5)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+5];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inR * chrp_allp_k[2];  
-            sp_chrp_alp3_buf[allp_idx] = inR - chrp_allp_k[2] * acc;			
-            inR = acc;
-            if (++chrp_alp3_idx[j+5] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+5] = 0; 
-
-			allp_idx = (j+6)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+6];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inR * chrp_allp_k[1];  
-            sp_chrp_alp3_buf[allp_idx] = inR - chrp_allp_k[1] * acc;			
-            inR = acc;
-            if (++chrp_alp3_idx[j+6] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+6] = 0; 
-
-			allp_idx = (j+7)*SPRVB_CHIRP3_LEN + chrp_alp3_idx[j+7];
-            acc = sp_chrp_alp3_buf[allp_idx]  + inR * chrp_allp_k[0];  
-            sp_chrp_alp3_buf[allp_idx] = inR - chrp_allp_k[0] * acc;			
-            inR = acc;
-            if (++chrp_alp3_idx[j+7] >= SPRVB_CHIRP3_LEN) chrp_alp3_idx[j+7] = 0; 
-            j = j + 8;
-        }
-		j = 0;
-        while(j < SPRVB_CHIRP_AMNT)
-        {	// channel L
-			allp_idx = j*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inL * chrp_allp_k[0];  
-            sp_chrp_alp4_buf[allp_idx] = inL - chrp_allp_k[0] * acc;
-            inL = acc;
-            if (++chrp_alp4_idx[j] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j] = 0;   
-            
-			allp_idx = (j+1)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+1];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inL * chrp_allp_k[1];  
-            sp_chrp_alp4_buf[allp_idx] = inL - chrp_allp_k[1] * acc;			
-            inL = acc;
-            if (++chrp_alp4_idx[j+1] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+1] = 0; 
-
-	        allp_idx = (j+2)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+2];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inL * chrp_allp_k[1];  
-            sp_chrp_alp4_buf[allp_idx] = inL - chrp_allp_k[1] * acc;			
-            inL = acc;
-            if (++chrp_alp4_idx[j+2] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+2] = 0; 
-
-			allp_idx = (j+3)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+3];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inL * chrp_allp_k[3];  
-            sp_chrp_alp4_buf[allp_idx] = inL - chrp_allp_k[3] * acc;			
-            inL = acc;
-            if (++chrp_alp4_idx[j+3] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+3] = 0; 
-			// channel R
-			allp_idx = (j+4)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+4];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inR * chrp_allp_k[3];  
-            sp_chrp_alp4_buf[allp_idx] = inR - chrp_allp_k[3] * acc;			
-            inR = acc;
-            if (++chrp_alp4_idx[j+4] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+4] = 0; 
-
-			allp_idx = (j+5)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+5];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inR * chrp_allp_k[2];  
-            sp_chrp_alp4_buf[allp_idx] = inR - chrp_allp_k[2] * acc;			
-            inR = acc;
-            if (++chrp_alp4_idx[j+5] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+5] = 0; 
-
-			allp_idx = (j+6)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+6];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inR * chrp_allp_k[1];  
-            sp_chrp_alp4_buf[allp_idx] = inR - chrp_allp_k[1] * acc;			
-            inR = acc;
-            if (++chrp_alp4_idx[j+6] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+6] = 0; 
-
-			allp_idx = (j+7)*SPRVB_CHIRP4_LEN + chrp_alp4_idx[j+7];
-            acc = sp_chrp_alp4_buf[allp_idx]  + inR * chrp_allp_k[0];  
-            sp_chrp_alp4_buf[allp_idx] = inR - chrp_allp_k[0] * acc;			
-            inR = acc;
-            if (++chrp_alp4_idx[j+7] >= SPRVB_CHIRP4_LEN) chrp_alp4_idx[j+7] = 0; 
-            j = j + 8;
-        }
+		if (chirp_xf)
+		{
+			xf = (float32_t)(i + 1) * (1.0f / AUDIO_BLOCK_SAMPLES);
+			sp_chrp_bank[0].process(inL, inR, xf);
+			sp_chrp_bank[1].process(inL, inR, xf);
+			sp_chrp_bank[2].process(inL, inR, xf);
+			sp_chrp_bank[3].process(inL, inR, xf);
+		}
+		else
+		{
+			sp_chrp_bank[0].process(inL, inR);
+			sp_chrp_bank[1].process(inL, inR);
+			sp_chrp_bank[2].process(inL, inR);
+			sp_chrp_bank[3].process(inL, inR);
+		}
 
 		// modulate the allpass filters
 		lfo.get(BASIC_LFO_PHASE_0, &offset, &lfo_fr); 
@@ -378,9 +199,15 @@ void AudioEffectSpringReverb_i16::update()
 		acc = sp_lp_allp2d.getTap(offset+1, lfo_fr);
 		sp_lp_allp2d.write_toOffset(acc, (lfo_ampl<<1)+1);
 
-        blockL->data[i] = (int16_t)((inL * wet_gain + dryL * dry_gain) * 32767.0f); 
-		blockR->data[i] = (int16_t)((inR * wet_gain + dryR * dry_gain) * 32767.0f);
+		wet_peak = fmaxf(wet_peak, fmaxf(fabsf(inL), fabsf(inR)));
+        blockL->data[i] = (int16_t)((inL * wet_gain + dryL[i] * dry_gain) * 32767.0f); 
+		blockR->data[i] = (int16_t)((inR * wet_gain + dryR[i] * dry_gain) * 32767.0f);
 	}
+	if (chirp_xf)
+	{
+		for (i = 0; i < 4; i++) sp_chrp_bank[i].stages_update();
+	}
+	if (autoIdle) idle.update(wet_peak);
     transmit(blockL, 0);
 	transmit(blockR, 1);
 	release(blockL);
@@ -388,6 +215,74 @@ void AudioEffectSpringReverb_i16::update()
 #endif
 }
 
+/**
+ * @brief Partial buffer clear
+ * 	Clearing all the reverb buffers at once takes too long 
+ * 	for the audio ISR. One allpass group, the chirp buffers or
+ *  a portion of a delay line is cleared per audio update.
+ * 
+ * @return true 	Memory clean is complete
+ * @return false 	Memory clean still in progress
+ */
+bool AudioEffectSpringReverb_i16::memCleanup()
+{
+	bool result = false;
+	switch(memCleanupIdx)
+	{
+		case 0:
+			sp_lp_allp1a.reset();
+			sp_lp_allp1b.reset();
+			sp_lp_allp1c.reset();
+			sp_lp_allp1d.reset();
+			memCleanupIdx++;
+			break;
+		case 1:
+			sp_lp_allp2a.reset();
+			sp_lp_allp2b.reset();
+			sp_lp_allp2c.reset();
+			sp_lp_allp2d.reset();
+			memCleanupIdx++;
+			break;
+		case 2:
+			sp_chrp_bank[0].reset();
+			sp_chrp_bank[1].reset();
+			sp_chrp_bank[2].reset();
+			sp_chrp_bank[3].reset();
+			memCleanupIdx++;
+			break;
+		case 3:		if (memCleanupDelay(lp_dly1)) memCleanupIdx++;	break;
+		case 4:		
+			if (memCleanupDelay(lp_dly2)) 
+			{
+				memCleanupIdx = 0;
+				result = true;
+			}
+			break;
+		default:
+			memCleanupIdx = 0;
+			break;
+	}
+	return result;
+}
+
+/**
+ * @brief clear one portion of the delay line
+ * 
+ * @param dly delay line
+ * @return true if the whole delay line is cleared
+ */
+bool AudioEffectSpringReverb_i16::memCleanupDelay(AudioBasicDelay &dly)
+{
+	dly.reset(memCleanupStart, memCleanupStart + memCleanupStep);
+	memCleanupStart += memCleanupStep;
+	if (memCleanupStart >= dly.size_get())
+	{
+		memCleanupStart = 0;
+		return true;
+	}
+	return false;
+}
+
 bool AudioEffectSpringReverb_i16::bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state)
 {
 	bool result = false;
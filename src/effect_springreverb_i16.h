@@ -36,25 +36,28 @@
 #include "arm_math.h"
 #include "basic_components.h"
 
-// Chirp allpass params
-#define SPRVB_CHIRP_AMNT   16      //must be mult of 8
-#define SPRVB_CHIRP1_LEN    3
-#define SPRVB_CHIRP2_LEN    5
-#define SPRVB_CHIRP3_LEN    6
-#define SPRVB_CHIRP4_LEN    7
-
-#define SPRVB_ALLP1A_LEN	(224)
-#define SPRVB_ALLP1B_LEN	(420)
-#define SPRVB_ALLP1C_LEN	(856)
-#define SPRVB_ALLP1D_LEN	(1089)
-
-#define SPRVB_ALLP2A_LEN	(156)
-#define SPRVB_ALLP2B_LEN	(478)
-#define SPRVB_ALLP2C_LEN	(956)
-#define SPRVB_ALLP2D_LEN	(1289)
-
-#define SPRVB_DLY1_LEN	(1945)
-#define SPRVB_DLY2_LEN	(1363)
+// Chirp allpass params, all lengths are tuned for BASIC_SR_REF and scaled to the current sample rate
+#define SPRVB_CHIRP_AMNT   16      // default allpass stages per length group, half for each channel
+#ifndef SPRVB_CHIRP_AMNT_MAX
+	#define SPRVB_CHIRP_AMNT_MAX	24	// buffers are allocated for this number of stages
+#endif
+#define SPRVB_CHIRP1_LEN    (sr_scale_len(3))
+#define SPRVB_CHIRP2_LEN    (sr_scale_len(5))
+#define SPRVB_CHIRP3_LEN    (sr_scale_len(6))
+#define SPRVB_CHIRP4_LEN    (sr_scale_len(7))
+
+#define SPRVB_ALLP1A_LEN	(sr_scale_len(224))
+#define SPRVB_ALLP1B_LEN	(sr_scale_len(420))
+#define SPRVB_ALLP1C_LEN	(sr_scale_len(856))
+#define SPRVB_ALLP1D_LEN	(sr_scale_len(1089))
+
+#define SPRVB_ALLP2A_LEN	(sr_scale_len(156))
+#define SPRVB_ALLP2B_LEN	(sr_scale_len(478))
+#define SPRVB_ALLP2C_LEN	(sr_scale_len(956))
+#define SPRVB_ALLP2D_LEN	(sr_scale_len(1289))
+
+#define SPRVB_DLY1_LEN	(sr_scale_len(1945))
+#define SPRVB_DLY2_LEN	(sr_scale_len(1363))
 
 class AudioEffectSpringReverb_i16 : public AudioStream
 {
@@ -119,6 +122,23 @@ public:
 		__enable_irq();
     }
     float32_t get_size(void) {return rv_time_k;}
+	/**
+	 * @brief number of the chirp (dispersion) allpass stages per length group, 
+	 * 		fewer stages = lower CPU load and less pronounced spring "boing"
+	 * 		The change is applied with the next processed audio block, the output is crossfaded
+	 * 		from the old to the new stage count over that block to avoid a click. 
+	 * 		Newly enabled stages start from cleared states.
+	 * 
+	 * @param n stages per group, even number from 2 to SPRVB_CHIRP_AMNT_MAX, default 16
+	 */
+	void chirp_stages(uint32_t n)
+	{
+		n = constrain(n, 2u, (uint32_t)SPRVB_CHIRP_AMNT_MAX) >> 1;
+		__disable_irq();
+		for (int i = 0; i < 4; i++) sp_chrp_bank[i].stages_set(n);
+		__enable_irq();
+	}
+	uint32_t chirp_stages_get() {return sp_chrp_bank[0].stages_get() << 1;}
 
 	// typedef enum
 	// {
@@ -146,6 +166,40 @@ public:
 		bypass_set(bp^1);
         return bp;
     } 
+	/**
+	 * @brief enables the automatic idle mode. If the input is silent and the reverb tail
+	 * 		has decayed below the threshold, the processing is skipped and no audio blocks
+	 * 		are transmitted. The first non silent input block resumes the processing.
+	 * 
+	 * @param state true = enabled
+	 */
+	void autoIdle_set(bool state)
+	{
+		__disable_irq();
+		autoIdle = state;
+		idle.reset();
+		__enable_irq();
+	}
+	bool autoIdle_get() {return autoIdle;}
+	/**
+	 * @brief sets the silence threshold used by the auto idle mode
+	 * 
+	 * @param thr max absolute sample value treated as silence
+	 */
+	void autoIdle_threshold(int16_t thr)
+	{
+		__disable_irq();
+		idle.threshold(thr);
+		__enable_irq();
+	}
+	bool idle_get() {return idle.get();}
+	/**
+	 * @brief buffer cleanup after bypassing the reverb is spread over several audio blocks,
+	 * 		the reverb stays bypassed until it's finished
+	 * 
+	 * @return true if the cleanup is in progress
+	 */
+	bool cleanup_busy() {return cleanupBusy;}
 private:
     audio_block_t *inputQueueArray[2];
 
@@ -160,10 +214,13 @@ private:
     bool bp = false;
 	bypass_mode_t bp_mode = BYPASS_MODE_PASS;
 	bool cleanup_done = false;
-    uint16_t chrp_alp1_idx[SPRVB_CHIRP_AMNT] = {0};
-    uint16_t chrp_alp2_idx[SPRVB_CHIRP_AMNT] = {0};
-    uint16_t chrp_alp3_idx[SPRVB_CHIRP_AMNT] = {0};
-    uint16_t chrp_alp4_idx[SPRVB_CHIRP_AMNT] = {0};
+	bool cleanupBusy = false;
+	bool autoIdle = false;
+	// the whole loop has to be flushed before going idle
+	static const uint32_t IDLE_HOLD_BLOCKS = (SPRVB_ALLP1A_LEN + SPRVB_ALLP1B_LEN + SPRVB_ALLP1C_LEN + SPRVB_ALLP1D_LEN +
+											  SPRVB_ALLP2A_LEN + SPRVB_ALLP2B_LEN + SPRVB_ALLP2D_LEN + SPRVB_ALLP2D_LEN +
+											  SPRVB_DLY1_LEN + SPRVB_DLY2_LEN) / AUDIO_BLOCK_SAMPLES + 1;
+	AudioBasicIdle idle;
 
     static constexpr float32_t rv_time_k_max = 0.97f;
     float32_t rv_time_k;
@@ -178,10 +235,8 @@ private:
 	AudioFilterAllpass<SPRVB_ALLP2D_LEN> sp_lp_allp2c;
 	AudioFilterAllpass<SPRVB_ALLP2D_LEN> sp_lp_allp2d;	
 
-    float32_t *sp_chrp_alp1_buf;
-    float32_t *sp_chrp_alp2_buf;
-    float32_t *sp_chrp_alp3_buf;
-    float32_t *sp_chrp_alp4_buf;
+	// chirp (dispersion) allpass chains, one bank per delay length
+	AudioFilterAllpassBank sp_chrp_bank[4];
 
 	AudioBasicDelay lp_dly1;
 	AudioBasicDelay lp_dly2;
@@ -196,11 +251,17 @@ private:
 	AudioFilterShelvingLPHP flt_lp1;
 	AudioFilterShelvingLPHP flt_lp2;
 
-	static const uint8_t lfo_ampl = 10;
+	static const uint8_t lfo_ampl = sr_scale_len(10);
 	AudioBasicLfo lfo = AudioBasicLfo(1.35f, lfo_ampl);
 
 	bool initialized = false;
 
+	bool memCleanup(void);
+	bool memCleanupDelay(AudioBasicDelay &dly);
+	const uint32_t memCleanupStep = 2048;
+	uint32_t memCleanupStart = 0;
+	uint8_t memCleanupIdx = 0;
+
 	bool bypass_process(audio_block_t** p_blockL, audio_block_t** p_blockR, bypass_mode_t mode, bool state);
 };
 